@@ -1,5 +1,6 @@
 ﻿using System;
 using System.Collections;
+using System.Collections.Generic;
 using System.Runtime.InteropServices;
 using System.Runtime.CompilerServices;
 using System.Reflection;
@@ -12,6 +13,58 @@ public class AlembicImporter
 {
     public delegate void aiNodeEnumerator(aiObject obj, IntPtr userdata);
 
+    [Flags]
+    public enum aiMeshProperty
+    {
+        Indices     = 1 << 0,
+        Counts      = 1 << 1,
+        Positions   = 1 << 2,
+        Velocities  = 1 << 3,
+        Normals     = 1 << 4,
+        UVs         = 1 << 5,
+        Tangents    = 1 << 6,
+
+        Topology    = Indices | Counts,
+    }
+
+    public enum aiCurvesProperty
+    {
+        Positions   = 1 << 0,
+        Counts      = 1 << 1,
+        Widths      = 1 << 2,
+    }
+
+    public enum aiPointsProperty
+    {
+        Positions   = 1 << 0,
+        Velocities  = 1 << 1,
+        IDs         = 1 << 2,
+    }
+
+    public enum aiSubframeMode
+    {
+        Nearest,
+        Velocity,
+        Linear,
+    }
+
+    public enum aiVertexFormat
+    {
+        Float,
+        Half4,
+        UNorm16x4,
+        Oct16,
+        UNorm16x2,
+    }
+
+    public struct aiQuantizationParams
+    {
+        public Vector3 position_offset;
+        public Vector3 position_scale;
+        public Vector2 uv_offset;
+        public Vector2 uv_scale;
+    }
+
     public struct aiSplitedMeshInfo
     {
         public int face_count;
@@ -22,17 +75,81 @@ public class AlembicImporter
         public int triangulated_index_count;
     }
 
-    public struct aiMeshData
+    public struct aiBakeSettings
     {
-        public int index_count;
-        public bool is_normal_indexed;
-        public bool is_uv_indexed;
+        public float start_time;
+        public float end_time;
+        public float frame_rate;
+        public int max_vertices;
+        public aiSubframeMode subframe_mode;
+        [MarshalAs(UnmanagedType.U1)] public bool reverse_index;
+        [MarshalAs(UnmanagedType.U1)] public bool share_vertices;
+        [MarshalAs(UnmanagedType.U1)] public bool generate_normals;
+        [MarshalAs(UnmanagedType.U1)] public bool generate_tangents;
+    }
+
+    public struct aiDeltaCacheSettings
+    {
+        public int keyframe_interval;
+        public float max_error;
+    }
+
+    public struct aiTextureMeshData
+    {
+        public int num_indices;
+        [MarshalAs(UnmanagedType.U1)] public bool is_normal_indexed;
+        [MarshalAs(UnmanagedType.U1)] public bool is_uv_indexed;
         public IntPtr tex_indices;
         public IntPtr tex_vertices;
         public IntPtr tex_normals;
         public IntPtr tex_uvs;
     }
 
+    public struct aiMeshSplitCounts
+    {
+        public int index_count;
+        public int vertex_count;
+        public aiMeshProperty written_flags;
+    }
+
+    public struct aiMeshOutputResult
+    {
+        public aiMeshProperty dirty_flags;
+        public int num_splits;
+        public int num_too_small;
+        public int max_splits;
+        public IntPtr split_counts;
+        public aiQuantizationParams quantization;
+    }
+
+    public struct aiCurvesSplitInfo
+    {
+        public int begin_curve;
+        public int num_curves;
+        public int begin_vertex;
+        public int num_vertices;
+        public int begin_index;
+        public int num_indices;
+    }
+
+    public struct aiCurvesData
+    {
+        public IntPtr positions;
+        public IntPtr widths;
+        public IntPtr indices;
+        public IntPtr curve_offsets;
+        public IntPtr curve_counts;
+    }
+
+    public struct aiPointsData
+    {
+        public IntPtr positions;
+        public IntPtr velocities;
+        public IntPtr ids;
+        public int capacity;
+        public int num_points;
+    }
+
     public struct aiCameraParams
     {
         public float near_clipping_plane;
@@ -59,23 +176,49 @@ public class AlembicImporter
     [DllImport ("AlembicImporter")] public static extern aiContext  aiCreateContext();
     [DllImport ("AlembicImporter")] public static extern void       aiDestroyContext(aiContext ctx);
     
+    [DllImport ("AlembicImporter")] public static extern void       aiSetNumReadStreams(aiContext ctx, int n);
+    [DllImport ("AlembicImporter")] public static extern void       aiEnableMemoryMapping(aiContext ctx, bool v);
+    [DllImport ("AlembicImporter")] public static extern void       aiSetSampleCacheCapacity(aiContext ctx, ulong bytes);
+    [DllImport ("AlembicImporter")] public static extern void       aiSetPrefetchCapacity(aiContext ctx, ulong bytes);
+    [DllImport ("AlembicImporter")] public static extern void       aiEnableDeltaCache(aiContext ctx, bool v);
+    [DllImport ("AlembicImporter")] public static extern void       aiSetDeltaCacheDirectory(aiContext ctx, string dir);
+    [DllImport ("AlembicImporter")] public static extern void       aiEnableDeltaCacheWriting(aiContext ctx, ref aiDeltaCacheSettings settings);
+    [DllImport ("AlembicImporter")] public static extern void       aiEnableTrackPreload(aiContext ctx, bool v);
+    [DllImport ("AlembicImporter")] public static extern void       aiEnableVisibilityCulling(aiContext ctx, bool v);
+    [DllImport ("AlembicImporter")] public static extern void       aiEnableLazyHierarchy(aiContext ctx, bool v);
     [DllImport ("AlembicImporter")] public static extern bool       aiLoad(aiContext ctx, string path);
     [DllImport ("AlembicImporter")] public static extern float      aiGetStartTime(aiContext ctx);
     [DllImport ("AlembicImporter")] public static extern float      aiGetEndTime(aiContext ctx);
     [DllImport ("AlembicImporter")] public static extern aiObject   aiGetTopObject(aiContext ctx);
+    [DllImport ("AlembicImporter")] public static extern int        aiGetNumNodes(aiContext ctx);
+    [DllImport ("AlembicImporter")] public static extern int        aiGetTransforms(aiContext ctx, Matrix4x4[] world, Matrix4x4[] local, int num_nodes);
+    [DllImport ("AlembicImporter")] public static extern int        aiGetVisibilities(aiContext ctx, [Out, MarshalAs(UnmanagedType.LPArray, ArraySubType = UnmanagedType.U1)] bool[] visible, int num_nodes);
+    [DllImport ("AlembicImporter")] public static extern void       aiUpdateSamples(aiContext ctx, float time);
+    [DllImport ("AlembicImporter")] public static extern void       aiWaitUpdate(aiContext ctx);
+    [DllImport ("AlembicImporter")] public static extern void       aiPrefetchSamples(aiContext ctx, float[] times, int num_times);
+    [DllImport ("AlembicImporter")] public static extern bool       aiBake(aiContext ctx, string path, ref aiBakeSettings settings);
+    [DllImport ("AlembicImporter")] public static extern bool       aiIsBaked(aiContext ctx);
+    [DllImport ("AlembicImporter")] public static extern bool       aiWriteDeltaCache(aiContext ctx, string path, ref aiDeltaCacheSettings settings);
     [DllImport ("AlembicImporter")] public static extern void       aiEnumerateChild(aiObject obj, aiNodeEnumerator e, IntPtr userdata);
     [DllImport ("AlembicImporter")] public static extern void       aiSetCurrentTime(aiObject obj, float time);
     [DllImport ("AlembicImporter")] public static extern void       aiEnableReverseX(aiObject obj, bool v);
     [DllImport ("AlembicImporter")] public static extern void       aiEnableTriangulate(aiObject obj, bool v);
+    [DllImport ("AlembicImporter")] public static extern void       aiEnableShareVertices(aiObject obj, bool v);
+    [DllImport ("AlembicImporter")] public static extern void       aiEnableGenerateNormals(aiObject obj, bool v);
+    [DllImport ("AlembicImporter")] public static extern void       aiEnableGenerateTangents(aiObject obj, bool v);
+    [DllImport ("AlembicImporter")] public static extern void       aiSetSubframeMode(aiObject obj, aiSubframeMode mode);
     [DllImport ("AlembicImporter")] public static extern void       aiEnableReverseIndex(aiObject obj, bool v);
 
     [DllImport ("AlembicImporter")] public static extern int        aiGetNumChildren(aiObject obj);
+    [DllImport ("AlembicImporter")] public static extern int        aiGetNodeID(aiObject obj);
+    [DllImport ("AlembicImporter")] public static extern bool       aiIsVisible(aiObject obj);
     [DllImport ("AlembicImporter")] private static extern IntPtr    aiGetNameS(aiObject obj);
     [DllImport ("AlembicImporter")] private static extern IntPtr    aiGetFullNameS(aiObject obj);
     public static string aiGetName(aiObject obj)      { return Marshal.PtrToStringAnsi(aiGetNameS(obj)); }
     public static string aiGetFullName(aiObject obj)  { return Marshal.PtrToStringAnsi(aiGetFullNameS(obj)); }
 
     [DllImport ("AlembicImporter")] public static extern bool       aiHasXForm(aiObject obj);
+    [DllImport ("AlembicImporter")] public static extern bool       aiXFormIsDirty(aiObject obj);
     [DllImport ("AlembicImporter")] public static extern bool       aiXFormGetInherits(aiObject obj);
     [DllImport ("AlembicImporter")] public static extern Vector3    aiXFormGetPosition(aiObject obj);
     [DllImport ("AlembicImporter")] public static extern Vector3    aiXFormGetAxis(aiObject obj);
@@ -88,6 +231,8 @@ public class AlembicImporter
     [DllImport ("AlembicImporter")] public static extern bool       aiPolyMeshIsTopologyConstantTriangles(aiObject obj);
     [DllImport ("AlembicImporter")] public static extern bool       aiPolyMeshHasNormals(aiObject obj);
     [DllImport ("AlembicImporter")] public static extern bool       aiPolyMeshHasUVs(aiObject obj);
+    [DllImport ("AlembicImporter")] public static extern bool       aiPolyMeshHasTangents(aiObject obj);
+    [DllImport ("AlembicImporter")] public static extern aiMeshProperty aiPolyMeshGetDirtyFlags(aiObject obj);
     [DllImport ("AlembicImporter")] public static extern int        aiPolyMeshGetIndexCount(aiObject obj);
     [DllImport ("AlembicImporter")] public static extern int        aiPolyMeshGetVertexCount(aiObject obj);
     [DllImport ("AlembicImporter")] public static extern void       aiPolyMeshCopyIndices(aiObject obj, IntPtr dst);
@@ -99,6 +244,28 @@ public class AlembicImporter
     [DllImport ("AlembicImporter")] public static extern void       aiPolyMeshCopySplitedVertices(aiObject obj, IntPtr vertices, ref aiSplitedMeshInfo smi);
     [DllImport ("AlembicImporter")] public static extern void       aiPolyMeshCopySplitedNormals(aiObject obj, IntPtr normals, ref aiSplitedMeshInfo smi);
     [DllImport ("AlembicImporter")] public static extern void       aiPolyMeshCopySplitedUVs(aiObject obj, IntPtr uvs, ref aiSplitedMeshInfo smi);
+    [DllImport ("AlembicImporter")] public static extern void       aiPolyMeshCopySplitedTangents(aiObject obj, IntPtr tangents, ref aiSplitedMeshInfo smi);
+    [DllImport ("AlembicImporter")] public static extern void       aiPolyMeshCopySplitedAttribute(aiObject obj, IntPtr dst, ref aiSplitedMeshInfo smi, aiMeshProperty attribute, aiVertexFormat format);
+    [DllImport ("AlembicImporter")] public static extern void       aiPolyMeshGetQuantizationParams(aiObject obj, ref aiQuantizationParams o_params);
+    [DllImport ("AlembicImporter")] public static extern void       aiPolyMeshCopyDataToTexture(aiObject obj, ref aiTextureMeshData dst);
+    [DllImport ("AlembicImporter")] public static extern void       aiPolyMeshSetOutputBuffer(aiObject obj, int split, aiMeshProperty attribute, IntPtr dst, int capacity);
+    [DllImport ("AlembicImporter")] public static extern void       aiPolyMeshSetOutputFormat(aiObject obj, aiMeshProperty attribute, aiVertexFormat format);
+    [DllImport ("AlembicImporter")] public static extern void       aiPolyMeshWriteOutputBuffers(aiObject obj, ref aiMeshOutputResult o_result, int max_vertices);
+
+    [DllImport ("AlembicImporter")] public static extern bool       aiHasCurves(aiObject obj);
+    [DllImport ("AlembicImporter")] public static extern aiCurvesProperty aiCurvesGetDirtyFlags(aiObject obj);
+    [DllImport ("AlembicImporter")] public static extern int        aiCurvesGetNumCurves(aiObject obj);
+    [DllImport ("AlembicImporter")] public static extern int        aiCurvesGetVertexCount(aiObject obj);
+    [DllImport ("AlembicImporter")] public static extern bool       aiCurvesHasWidths(aiObject obj);
+    [DllImport ("AlembicImporter")] public static extern int        aiCurvesGetSplits(aiObject obj, aiCurvesSplitInfo[] dst, int max_splits, int max_vertices);
+    [DllImport ("AlembicImporter")] public static extern void       aiCurvesCopySplitData(aiObject obj, ref aiCurvesData dst, ref aiCurvesSplitInfo split);
+
+    [DllImport ("AlembicImporter")] public static extern bool       aiHasPoints(aiObject obj);
+    [DllImport ("AlembicImporter")] public static extern void       aiPointsEnableSort(aiObject obj, bool v);
+    [DllImport ("AlembicImporter")] public static extern bool       aiPointsHasVelocities(aiObject obj);
+    [DllImport ("AlembicImporter")] public static extern aiPointsProperty aiPointsGetDirtyFlags(aiObject obj);
+    [DllImport ("AlembicImporter")] public static extern int        aiPointsGetCount(aiObject obj);
+    [DllImport ("AlembicImporter")] public static extern bool       aiPointsCopyData(aiObject obj, ref aiPointsData data);
 
     [DllImport ("AlembicImporter")] public static extern bool       aiHasCamera(aiObject obj);
     [DllImport ("AlembicImporter")] public static extern void       aiCameraGetParams(aiObject obj, ref aiCameraParams o_params);
@@ -108,10 +275,17 @@ public class AlembicImporter
 
     class ImportContext
     {
+        public aiContext ctx;
         public Transform parent;
-        public float time;
         public bool reverse_x;
         public bool reverse_faces;
+        public bool share_vertices;
+        public bool generate_normals;
+        public bool generate_tangents;
+        public aiSubframeMode subframe_mode;
+        public bool visibility_culling;
+        public Transform[] nodes; // indexed by aiGetNodeID()
+        public List<Transform> cameras = new List<Transform>();
     }
 
 #if UNITY_EDITOR
@@ -161,28 +335,84 @@ public class AlembicImporter
             abcstream.m_reverse_x = reverse_x;
             abcstream.m_reverse_faces = reverse_faces;
 
-            var ic = new ImportContext();
-            ic.parent = root.GetComponent<Transform>();
-            ic.reverse_x = reverse_x;
-            ic.reverse_faces = reverse_faces;
-
-            GCHandle gch = GCHandle.Alloc(ic);
-            aiEnumerateChild(aiGetTopObject(ctx), ImportEnumerator, GCHandle.ToIntPtr(gch));
+            aiUpdateSamples(ctx, 0.0f);
+            UpdateAbcTree(ctx, root.GetComponent<Transform>(), reverse_x, reverse_faces, abcstream.m_share_vertices, abcstream.m_generate_normals, abcstream.m_generate_tangents, abcstream.m_subframe_mode, false);
+            ReleaseOutputBuffers(root.GetComponent<Transform>());
         }
         aiDestroyContext(ctx);
     }
 #endif
 
-    public static void UpdateAbcTree(aiContext ctx, Transform root, bool reverse_x, bool reverse_faces, float time)
+    // samples must have been requested by aiUpdateSamples() beforehand
+    public static void UpdateAbcTree(aiContext ctx, Transform root, bool reverse_x, bool reverse_faces, bool share_vertices, bool generate_normals, bool generate_tangents, aiSubframeMode subframe_mode, bool visibility_culling)
     {
         var ic = new ImportContext();
+        ic.ctx = ctx;
         ic.parent = root;
-        ic.time = time;
         ic.reverse_x = reverse_x;
         ic.reverse_faces = reverse_faces;
+        ic.share_vertices = share_vertices;
+        ic.generate_normals = generate_normals;
+        ic.generate_tangents = generate_tangents;
+        ic.subframe_mode = subframe_mode;
+        ic.visibility_culling = visibility_culling;
+        ic.nodes = new Transform[aiGetNumNodes(ctx)];
+
+        aiWaitUpdate(ctx);
 
         GCHandle gch = GCHandle.Alloc(ic);
         aiEnumerateChild(aiGetTopObject(ctx), ImportEnumerator, GCHandle.ToIntPtr(gch));
+        gch.Free();
+
+        // all transforms in one call. this must come after the enumeration as it sets reverse_x of each node
+        var locals = new Matrix4x4[ic.nodes.Length];
+        var visible = new bool[ic.nodes.Length];
+        aiGetTransforms(ctx, null, locals, locals.Length);
+        aiGetVisibilities(ctx, visible, visible.Length);
+        for (int i = 0; i < ic.nodes.Length; ++i)
+        {
+            var trans = ic.nodes[i];
+            if (trans != null)
+            {
+                SetLocalMatrix(trans, ref locals[i]);
+                SetRenderersEnabled(trans, visible[i]);
+            }
+        }
+        foreach (var trans in ic.cameras)
+        {
+            trans.parent.forward = -trans.parent.forward;
+        }
+    }
+
+    static void SetLocalMatrix(Transform trans, ref Matrix4x4 m)
+    {
+        Vector3 x = m.GetColumn(0);
+        Vector3 y = m.GetColumn(1);
+        Vector3 z = m.GetColumn(2);
+        Vector3 scale = new Vector3(x.magnitude, y.magnitude, z.magnitude);
+        if (Vector3.Dot(Vector3.Cross(x, y), z) < 0.0f)
+        {
+            // mirrored. fold it into x
+            scale.x = -scale.x;
+        }
+        trans.localPosition = m.GetColumn(3);
+        trans.localRotation = scale.y != 0.0f && scale.z != 0.0f ? Quaternion.LookRotation(z, y) : Quaternion.identity;
+        trans.localScale = scale;
+    }
+
+    // hidden objects keep their meshes, only their renderers are turned off
+    static void SetRenderersEnabled(Transform trans, bool v)
+    {
+        var abcmesh = trans.GetComponent<AlembicMesh>();
+        if (abcmesh == null) { return; }
+        foreach (var entry in abcmesh.m_meshes)
+        {
+            var renderer = entry.host.GetComponent<MeshRenderer>();
+            if (renderer != null && renderer.enabled != v)
+            {
+                renderer.enabled = v;
+            }
+        }
     }
 
     static void ImportEnumerator(aiObject obj, IntPtr userdata)
@@ -191,9 +421,12 @@ public class AlembicImporter
         Transform parent = ic.parent;
         //Debug.Log("Node: " + aiGetFullName(ctx) + " (" + (xf ? "x" : "") + (mesh ? "p" : "") + ")");
 
-        aiSetCurrentTime(obj, ic.time);
         aiEnableReverseX(obj, ic.reverse_x);
         aiEnableReverseIndex(obj, ic.reverse_faces);
+        aiEnableShareVertices(obj, ic.share_vertices);
+        aiEnableGenerateNormals(obj, ic.generate_normals);
+        aiEnableGenerateTangents(obj, ic.generate_tangents);
+        aiSetSubframeMode(obj, ic.subframe_mode);
         string child_name = aiGetName(obj);
         var trans = parent.FindChild(child_name);
         if (trans == null)
@@ -204,37 +437,30 @@ public class AlembicImporter
             trans.parent = parent;
         }
 
-        if (aiHasXForm(obj))
+        // transforms are applied by UpdateAbcTree() in one batch. with a lazy hierarchy, nodes get their ids as they
+        // are enumerated for the first time
+        int id = aiGetNodeID(obj);
+        if (id >= ic.nodes.Length)
         {
-            Vector3 pos = aiXFormGetPosition(obj);
-            Quaternion rot = Quaternion.AngleAxis(aiXFormGetAngle(obj), aiXFormGetAxis(obj));
-            Vector3 scale = aiXFormGetScale(obj);
-            if (aiXFormGetInherits(obj))
+            Array.Resize(ref ic.nodes, Math.Max(id + 1, ic.nodes.Length * 2));
+        }
+        ic.nodes[id] = trans;
+
+        // with visibility culling, the samples of hidden meshes may not have been read at all
+        if (aiHasPolyMesh(obj))
+        {
+            if (!ic.visibility_culling || aiIsVisible(obj))
             {
-                trans.localPosition = pos;
-                trans.localRotation = rot;
-                trans.localScale = scale;
+                UpdateAbcMesh(ic.ctx, obj, trans);
             }
             else
             {
-                trans.position = pos;
-                trans.rotation = rot;
-                trans.localScale = scale;
+                InvalidateAbcMesh(trans);
             }
         }
-        else
-        {
-            trans.localPosition = Vector3.zero;
-            trans.localEulerAngles = Vector3.zero;
-            trans.localScale = Vector3.one;
-        }
-        if (aiHasPolyMesh(obj))
-        {
-            UpdateAbcMesh(obj, trans);
-        }
         if (aiHasCamera(obj))
         {
-            trans.parent.forward = -trans.parent.forward;
+            ic.cameras.Add(trans);
             UpdateAbcCamera(obj, trans);
         }
         if (aiHasLight(obj))
@@ -248,7 +474,7 @@ public class AlembicImporter
     }
 
 
-    public static void UpdateAbcMesh(aiObject abc, Transform trans)
+    public static void UpdateAbcMesh(aiContext ctx, aiObject abc, Transform trans)
     {
         const int max_vertices = 65000;
 
@@ -260,7 +486,9 @@ public class AlembicImporter
                 host = trans.gameObject,
                 mesh = AddMeshComponents(abc, trans),
                 vertex_cache = new Vector3[0],
+                normal_cache = new Vector3[0],
                 uv_cache = new Vector2[0],
+                tangent_cache = new Vector4[0],
                 index_cache = new int[0],
             };
             abcmesh.m_meshes.Add(entry);
@@ -300,101 +528,208 @@ public class AlembicImporter
         }
          */
 
-        aiSplitedMeshInfo smi_prev = default(aiSplitedMeshInfo);
-        aiSplitedMeshInfo smi = default(aiSplitedMeshInfo);
-
-        int nth_submesh = 0;
-        for (; ; )
+        // the plugin writes straight into the caches of each submesh, registered once as its output buffers, from
+        // the update task of the mesh. this only hands the result to the meshes. when submeshes are added, their
+        // sizes change or attributes come and go, their caches are registered again and written in full by one more call
+        aiMeshProperty attributes = GetOutputAttributes(abc);
+        for (;;)
         {
-            smi_prev = smi;
-            smi = default(aiSplitedMeshInfo);
-            bool is_end = aiPolyMeshGetSplitedMeshInfo(abc, ref smi, ref smi_prev, max_vertices);
-
-            AlembicMesh.Entry entry;
-            if (nth_submesh < abcmesh.m_meshes.Count)
+            aiMeshOutputResult result = default(aiMeshOutputResult);
+            var counts_handle = GCHandle.Alloc(abcmesh.m_split_counts, GCHandleType.Pinned);
+            result.max_splits = abcmesh.m_split_counts.Length;
+            result.split_counts = counts_handle.AddrOfPinnedObject();
+            aiPolyMeshWriteOutputBuffers(abc, ref result, max_vertices);
+            counts_handle.Free();
+
+            if (result.num_splits > abcmesh.m_split_counts.Length)
             {
-                entry = abcmesh.m_meshes[nth_submesh];
-                entry.host.SetActive(true);
+                abcmesh.m_split_counts = new aiMeshSplitCounts[result.num_splits];
+                continue;
             }
-            else
+
+            bool registered = false;
+            for (int nth_submesh = 0; nth_submesh < result.num_splits; ++nth_submesh)
             {
-                string name = "Submesh_" + nth_submesh;
-
-                GameObject go = new GameObject();
-                Transform child = go.GetComponent<Transform>();
-                go.name = name;
-                child.parent = trans;
-                child.localPosition = Vector3.zero;
-                child.localEulerAngles = Vector3.zero;
-                child.localScale = Vector3.one;
-                Mesh mesh = AddMeshComponents(abc, child);
-                mesh.name = name;
-                child.GetComponent<MeshRenderer>().sharedMaterial = material;
-
-                entry = new AlembicMesh.Entry
+                AlembicMesh.Entry entry = GetMeshEntry(abcmesh, abc, trans, material, nth_submesh);
+                aiMeshSplitCounts counts = abcmesh.m_split_counts[nth_submesh];
+                if (entry.registered_to != abc.ptr ||
+                    entry.registered_attributes != attributes ||
+                    entry.index_cache.Length != counts.index_count ||
+                    entry.vertex_cache.Length != counts.vertex_count)
+                {
+                    RegisterOutputBuffers(ctx, abc, nth_submesh, entry, counts, attributes);
+                    registered = true;
+                }
+                else
                 {
-                    host = go,
-                    mesh = mesh,
-                    vertex_cache = new Vector3[0],
-                    uv_cache = new Vector2[0],
-                    index_cache = new int[0],
-                };
-                abcmesh.m_meshes.Add(entry);
+                    UpdateMeshEntry(abc, entry, counts.written_flags);
+                }
             }
 
-            bool needs_index_update = entry.mesh.vertexCount == 0 || !aiPolyMeshIsTopologyConstant(abc);
-            if (needs_index_update)
+            if (!registered)
             {
-                entry.mesh.Clear();
+                for (int i = result.num_splits; i < abcmesh.m_meshes.Count; ++i)
+                {
+                    abcmesh.m_meshes[i].host.SetActive(false);
+                }
+                break;
             }
+        }
+    }
 
-            // update positions
-            {
-                Array.Resize(ref entry.vertex_cache, smi.vertex_count);
-                aiPolyMeshCopySplitedVertices(abc, Marshal.UnsafeAddrOfPinnedArrayElement(entry.vertex_cache, 0), ref smi);
-                entry.mesh.vertices = entry.vertex_cache;
-            }
+    // the plugin writes only what changed since its last write, which misses whatever changed while a mesh was
+    // skipped. its buffers are registered again when it shows up, so that they are written in full
+    static void InvalidateAbcMesh(Transform trans)
+    {
+        var abcmesh = trans.GetComponent<AlembicMesh>();
+        if (abcmesh == null) { return; }
+        abcmesh.ReleaseBuffers();
+    }
 
-            // update normals
-            if (aiPolyMeshHasNormals(abc))
-            {
-                // normals can reuse entry.vertex_cache
-                aiPolyMeshCopySplitedNormals(abc, Marshal.UnsafeAddrOfPinnedArrayElement(entry.vertex_cache, 0), ref smi);
-                entry.mesh.normals = entry.vertex_cache;
-            }
+    // takes back the caches of all meshes under root from the plugin. must be called before their context is
+    // destroyed, which would leave them registered to objects that no longer exist
+    public static void ReleaseOutputBuffers(Transform root)
+    {
+        foreach (var abcmesh in root.GetComponentsInChildren<AlembicMesh>(true))
+        {
+            abcmesh.ReleaseBuffers();
+        }
+    }
 
-            if (needs_index_update)
+    static AlembicMesh.Entry GetMeshEntry(AlembicMesh abcmesh, aiObject abc, Transform trans, Material material, int nth_submesh)
+    {
+        AlembicMesh.Entry entry;
+        if (nth_submesh < abcmesh.m_meshes.Count)
+        {
+            entry = abcmesh.m_meshes[nth_submesh];
+            entry.host.SetActive(true);
+        }
+        else
+        {
+            string name = "Submesh_" + nth_submesh;
+
+            GameObject go = new GameObject();
+            Transform child = go.GetComponent<Transform>();
+            go.name = name;
+            child.parent = trans;
+            child.localPosition = Vector3.zero;
+            child.localEulerAngles = Vector3.zero;
+            child.localScale = Vector3.one;
+            Mesh mesh = AddMeshComponents(abc, child);
+            mesh.name = name;
+            child.GetComponent<MeshRenderer>().sharedMaterial = material;
+
+            entry = new AlembicMesh.Entry
             {
-                // update uvs
-                if (aiPolyMeshHasUVs(abc))
-                {
-                    Array.Resize(ref entry.uv_cache, smi.vertex_count);
-                    aiPolyMeshCopySplitedUVs(abc, Marshal.UnsafeAddrOfPinnedArrayElement(entry.uv_cache, 0), ref smi);
-                    entry.mesh.uv = entry.uv_cache;
-                }
+                host = go,
+                mesh = mesh,
+                vertex_cache = new Vector3[0],
+                normal_cache = new Vector3[0],
+                uv_cache = new Vector2[0],
+                tangent_cache = new Vector4[0],
+                index_cache = new int[0],
+            };
+            abcmesh.m_meshes.Add(entry);
+        }
+        return entry;
+    }
 
-                // update indices
-                Array.Resize(ref entry.index_cache, smi.triangulated_index_count);
-                aiPolyMeshCopySplitedIndices(abc, Marshal.UnsafeAddrOfPinnedArrayElement(entry.index_cache, 0), ref smi);
-                entry.mesh.SetIndices(entry.index_cache, MeshTopology.Triangles, 0);
-            }
+    // attributes the mesh has at the current sample, that are written into output buffers
+    static aiMeshProperty GetOutputAttributes(aiObject abc)
+    {
+        aiMeshProperty attributes = aiMeshProperty.Indices | aiMeshProperty.Positions;
+        if (aiPolyMeshHasNormals(abc)) { attributes |= aiMeshProperty.Normals; }
+        if (aiPolyMeshHasUVs(abc)) { attributes |= aiMeshProperty.UVs; }
+        if (aiPolyMeshHasTangents(abc)) { attributes |= aiMeshProperty.Tangents; }
+        return attributes;
+    }
 
-            // recalculate normals
-            if (!aiPolyMeshHasNormals(abc))
-            {
-                entry.mesh.RecalculateNormals();
-            }
+    // sizes the caches of entry to counts, pins them and registers them as the output buffers of the submesh.
+    // the attributes the mesh doesn't have are unregistered, as their caches are no longer pinned
+    static void RegisterOutputBuffers(aiContext ctx, aiObject abc, int nth_submesh, AlembicMesh.Entry entry, aiMeshSplitCounts counts, aiMeshProperty attributes)
+    {
+        entry.ReleaseBuffers();
 
-            ++nth_submesh;
-            if (is_end) { break; }
+        Array.Resize(ref entry.index_cache, counts.index_count);
+        RegisterOutputBuffer(abc, nth_submesh, aiMeshProperty.Indices, entry, entry.index_cache);
+        Array.Resize(ref entry.vertex_cache, counts.vertex_count);
+        RegisterOutputBuffer(abc, nth_submesh, aiMeshProperty.Positions, entry, entry.vertex_cache);
+        if ((attributes & aiMeshProperty.Normals) != 0)
+        {
+            Array.Resize(ref entry.normal_cache, counts.vertex_count);
+            RegisterOutputBuffer(abc, nth_submesh, aiMeshProperty.Normals, entry, entry.normal_cache);
         }
-
-        for (int i = nth_submesh + 1; i < abcmesh.m_meshes.Count; ++i)
+        else
+        {
+            aiPolyMeshSetOutputBuffer(abc, nth_submesh, aiMeshProperty.Normals, IntPtr.Zero, 0);
+        }
+        if ((attributes & aiMeshProperty.UVs) != 0)
+        {
+            Array.Resize(ref entry.uv_cache, counts.vertex_count);
+            RegisterOutputBuffer(abc, nth_submesh, aiMeshProperty.UVs, entry, entry.uv_cache);
+        }
+        else
         {
-            abcmesh.m_meshes[i].host.SetActive(false);
+            aiPolyMeshSetOutputBuffer(abc, nth_submesh, aiMeshProperty.UVs, IntPtr.Zero, 0);
         }
+        if ((attributes & aiMeshProperty.Tangents) != 0)
+        {
+            Array.Resize(ref entry.tangent_cache, counts.vertex_count);
+            RegisterOutputBuffer(abc, nth_submesh, aiMeshProperty.Tangents, entry, entry.tangent_cache);
+        }
+        else
+        {
+            aiPolyMeshSetOutputBuffer(abc, nth_submesh, aiMeshProperty.Tangents, IntPtr.Zero, 0);
+        }
+        entry.registered_ctx = ctx;
+        entry.registered_to = abc.ptr;
+        entry.registered_split = nth_submesh;
+        entry.registered_attributes = attributes;
     }
 
+    static void RegisterOutputBuffer(aiObject abc, int nth_submesh, aiMeshProperty attribute, AlembicMesh.Entry entry, Array cache)
+    {
+        var handle = GCHandle.Alloc(cache, GCHandleType.Pinned);
+        entry.handles.Add(handle);
+        aiPolyMeshSetOutputBuffer(abc, nth_submesh, attribute, handle.AddrOfPinnedObject(), cache.Length);
+    }
+
+    // hands the caches the plugin has just written to the mesh
+    static void UpdateMeshEntry(aiObject abc, AlembicMesh.Entry entry, aiMeshProperty written)
+    {
+        bool indices_written = (written & aiMeshProperty.Indices) != 0;
+        bool positions_written = (written & aiMeshProperty.Positions) != 0;
+        if (indices_written)
+        {
+            entry.mesh.Clear();
+        }
+        if (positions_written)
+        {
+            entry.mesh.vertices = entry.vertex_cache;
+        }
+        if ((written & aiMeshProperty.Normals) != 0)
+        {
+            entry.mesh.normals = entry.normal_cache;
+        }
+        if ((written & aiMeshProperty.UVs) != 0)
+        {
+            entry.mesh.uv = entry.uv_cache;
+        }
+        if ((written & aiMeshProperty.Tangents) != 0)
+        {
+            entry.mesh.tangents = entry.tangent_cache;
+        }
+        if (indices_written)
+        {
+            entry.mesh.SetIndices(entry.index_cache, MeshTopology.Triangles, 0);
+        }
+
+        // recalculate normals. only when the plugin doesn't generate them
+        if (!aiPolyMeshHasNormals(abc) && positions_written)
+        {
+            entry.mesh.RecalculateNormals();
+        }
+    }
 
     static Mesh AddMeshComponents(aiObject abc, Transform trans)
     {
@@ -17,13 +17,43 @@ public class AlembicMesh : MonoBehaviour
     {
         public int[] index_cache;
         public Vector3[] vertex_cache;
+        public Vector3[] normal_cache;
         public Vector2[] uv_cache;
+        public Vector4[] tangent_cache;
         public Mesh mesh;
         public GameObject host;
+
+        // the caches above stay pinned while the plugin holds them as output buffers of split registered_split of
+        // registered_to, which the update tasks of registered_ctx write into
+        [NonSerialized] public List<GCHandle> handles = new List<GCHandle>();
+        [NonSerialized] public AlembicImporter.aiContext registered_ctx;
+        [NonSerialized] public IntPtr registered_to;
+        [NonSerialized] public int registered_split;
+        [NonSerialized] public AlembicImporter.aiMeshProperty registered_attributes;
+
+        // takes the caches back from the plugin once its update is done, then unpins them
+        public void ReleaseBuffers()
+        {
+            if (registered_to != IntPtr.Zero)
+            {
+                AlembicImporter.aiWaitUpdate(registered_ctx);
+                var abc = new AlembicImporter.aiObject { ptr = registered_to };
+                AlembicImporter.aiPolyMeshSetOutputBuffer(abc, registered_split, AlembicImporter.aiMeshProperty.Indices, IntPtr.Zero, 0);
+                AlembicImporter.aiPolyMeshSetOutputBuffer(abc, registered_split, AlembicImporter.aiMeshProperty.Positions, IntPtr.Zero, 0);
+                AlembicImporter.aiPolyMeshSetOutputBuffer(abc, registered_split, AlembicImporter.aiMeshProperty.Normals, IntPtr.Zero, 0);
+                AlembicImporter.aiPolyMeshSetOutputBuffer(abc, registered_split, AlembicImporter.aiMeshProperty.UVs, IntPtr.Zero, 0);
+                AlembicImporter.aiPolyMeshSetOutputBuffer(abc, registered_split, AlembicImporter.aiMeshProperty.Tangents, IntPtr.Zero, 0);
+            }
+            if (handles == null) { handles = new List<GCHandle>(); }
+            foreach (var h in handles) { h.Free(); }
+            handles.Clear();
+            registered_to = IntPtr.Zero;
+        }
     }
 
     public IntPtr m_abc_mesh;
     public List<Entry> m_meshes = new List<Entry>();
+    public AlembicImporter.aiMeshSplitCounts[] m_split_counts = new AlembicImporter.aiMeshSplitCounts[1];
 
     public RenderTexture m_indices;
     public RenderTexture m_vertices;
@@ -34,7 +64,7 @@ public class AlembicMesh : MonoBehaviour
     static RenderTexture CreateDataTexture(int num_data, RenderTextureFormat format)
     {
         const int width = 1024;
-        var r = new RenderTexture(width, num_data / width, 0, format);
+        var r = new RenderTexture(width, (num_data + width - 1) / width, 0, format);
         r.enableRandomWrite = true;
         r.Create();
         return r;
@@ -49,4 +79,15 @@ public class AlembicMesh : MonoBehaviour
     {
 
     }
+
+    // entries still registered have a live context: AlembicStream and the importer release them before destroying theirs
+    void OnDestroy()
+    {
+        ReleaseBuffers();
+    }
+
+    public void ReleaseBuffers()
+    {
+        foreach (var e in m_meshes) { e.ReleaseBuffers(); }
+    }
 }
@@ -23,9 +23,22 @@ public class AlembicStream : MonoBehaviour
     public CycleType m_cycle = CycleType.Hold;
     public bool m_reverse_x;
     public bool m_reverse_faces;
+    public bool m_share_vertices = false; // weld face corners of split meshes instead of a vertex per corner
+    public bool m_generate_normals = false; // compute smooth normals in the plugin for meshes that have none
+    public bool m_generate_tangents = false; // compute tangents in the plugin for normal mapped materials
+    public AlembicImporter.aiSubframeMode m_subframe_mode = AlembicImporter.aiSubframeMode.Nearest; // Velocity: move points by velocities between samples. Linear: blend samples
+    public int m_read_streams = 0; // 0: one per worker thread
+    public bool m_memory_mapping = false;
+    public bool m_visibility_culling = false; // don't read the samples of objects while they are hidden
+    public bool m_lazy_hierarchy = false; // make the objects of huge archives only as they are first enumerated
+    public int m_sample_cache_mb = 0; // 0: no sample cache
+    public int m_prefetch_frames = 0; // number of upcoming frames read ahead in background. 0: no prefetch
+    public int m_prefetch_mb = 256;
     bool m_loaded;
+    bool m_update_requested;
     float m_time_prev;
     float m_time_eps = 0.001f;
+    float[] m_prefetch_times;
     AlembicImporter.aiContext m_abc;
 
 
@@ -35,11 +48,18 @@ public class AlembicStream : MonoBehaviour
         AlembicImporter.AddLibraryPath();
 #endif
         m_abc = AlembicImporter.aiCreateContext();
+        AlembicImporter.aiSetNumReadStreams(m_abc, m_read_streams);
+        AlembicImporter.aiEnableMemoryMapping(m_abc, m_memory_mapping);
+        AlembicImporter.aiSetSampleCacheCapacity(m_abc, (ulong)m_sample_cache_mb * 1024 * 1024);
+        AlembicImporter.aiSetPrefetchCapacity(m_abc, m_prefetch_frames > 0 ? (ulong)m_prefetch_mb * 1024 * 1024 : 0);
+        AlembicImporter.aiEnableVisibilityCulling(m_abc, m_visibility_culling);
+        AlembicImporter.aiEnableLazyHierarchy(m_abc, m_lazy_hierarchy);
         m_loaded = AlembicImporter.aiLoad(m_abc, m_path_to_abc);
     }
 
     void OnDisable()
     {
+        AlembicImporter.ReleaseOutputBuffers(GetComponent<Transform>());
         AlembicImporter.aiDestroyContext(m_abc);
     }
 
@@ -129,9 +149,38 @@ public class AlembicStream : MonoBehaviour
 
             if (Math.Abs(m_time - m_time_prev) > m_time_eps)
             {
-                AlembicImporter.UpdateAbcTree(m_abc, GetComponent<Transform>(), m_reverse_x, m_reverse_faces, AdjustTime(m_time));
+                // samples are read on worker threads until LateUpdate()
+                AlembicImporter.aiUpdateSamples(m_abc, AdjustTime(m_time));
+                m_update_requested = true;
                 m_time_prev = m_time;
+                Prefetch();
             }
         }
     }
+
+    // predict the times of upcoming frames assuming the current frame rate. AdjustTime() takes care of
+    // time scale and cycle type, so looping and reversed playback read ahead in the right direction.
+    void Prefetch()
+    {
+        if (m_prefetch_frames <= 0) { return; }
+
+        if (m_prefetch_times == null || m_prefetch_times.Length != m_prefetch_frames)
+        {
+            m_prefetch_times = new float[m_prefetch_frames];
+        }
+        for (int i = 0; i < m_prefetch_frames; ++i)
+        {
+            m_prefetch_times[i] = AdjustTime(m_time + Time.deltaTime * (i + 1));
+        }
+        AlembicImporter.aiPrefetchSamples(m_abc, m_prefetch_times, m_prefetch_frames);
+    }
+
+    void LateUpdate()
+    {
+        if (m_update_requested)
+        {
+            AlembicImporter.UpdateAbcTree(m_abc, GetComponent<Transform>(), m_reverse_x, m_reverse_faces, m_share_vertices, m_generate_normals, m_generate_tangents, m_subframe_mode, m_visibility_culling);
+            m_update_requested = false;
+        }
+    }
 }
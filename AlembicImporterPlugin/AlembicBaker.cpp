@@ -0,0 +1,103 @@
+﻿#include "pch.h"
+#include "AlembicImporter.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// offline converter from Alembic archives to baked caches (see aiBakedCache.h), built with the plugin sources.
+// it evaluates the archive with the same code as playback does, so baked meshes are exactly what the plugin
+// would have produced with the same options. the visibility of nodes is baked per frame, hidden meshes included.
+// with -deltacache it writes the delta cache of the archive (see aiDeltaCache.h) instead, ahead of the first playback.
+
+static void PrintUsage()
+{
+    printf(
+        "usage: AlembicBaker [options] input.abc output.abcb\n"
+        "       AlembicBaker -deltacache [delta options] input.abc [output.delta]\n"
+        "  -fps <rate>           frames per second to sample at (default: 30)\n"
+        "  -start <time>         first frame (default: start of the archive)\n"
+        "  -end <time>           last frame (default: end of the archive)\n"
+        "  -maxvertices <n>      vertices per split (default: 65000)\n"
+        "  -interpolate          blend samples at frames between them instead of taking the nearest one\n"
+        "  -reverseindex         reverse the winding of faces\n"
+        "  -sharevertices        weld face corners with the same position, normal and uv\n"
+        "  -generatenormals      smooth normals for meshes without normals\n"
+        "  -generatetangents     tangents for meshes with normals and uvs\n"
+        "delta options (output defaults to input.abc.delta, where playback looks for it):\n"
+        "  -keyinterval <n>      at most n samples between keyframes (default: 16)\n"
+        "  -maxerror <e>         largest position error allowed. 0: lossless (default: 0)\n");
+}
+
+int main(int argc, char *argv[])
+{
+    aiBakeSettings settings;
+    memset(&settings, 0, sizeof(settings));
+    settings.frame_rate = 30.0f;
+    settings.max_vertices = 65000;
+    settings.subframe_mode = aiSubframeMode_Nearest;
+    aiDeltaCacheSettings delta_settings;
+    delta_settings.keyframe_interval = 16;
+    delta_settings.max_error = 0.0f;
+    bool has_start = false, has_end = false, delta_cache = false;
+    const char *paths[2] = { nullptr, nullptr };
+    int num_paths = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(arg, "-fps") == 0 && has_value)                  { settings.frame_rate = (float)atof(argv[++i]); }
+        else if (strcmp(arg, "-start") == 0 && has_value)           { settings.start_time = (float)atof(argv[++i]); has_start = true; }
+        else if (strcmp(arg, "-end") == 0 && has_value)             { settings.end_time = (float)atof(argv[++i]); has_end = true; }
+        else if (strcmp(arg, "-maxvertices") == 0 && has_value)     { settings.max_vertices = atoi(argv[++i]); }
+        else if (strcmp(arg, "-interpolate") == 0)                  { settings.subframe_mode = aiSubframeMode_Linear; }
+        else if (strcmp(arg, "-reverseindex") == 0)                 { settings.reverse_index = true; }
+        else if (strcmp(arg, "-sharevertices") == 0)                { settings.share_vertices = true; }
+        else if (strcmp(arg, "-generatenormals") == 0)              { settings.generate_normals = true; }
+        else if (strcmp(arg, "-generatetangents") == 0)             { settings.generate_tangents = true; }
+        else if (strcmp(arg, "-deltacache") == 0)                   { delta_cache = true; }
+        else if (strcmp(arg, "-keyinterval") == 0 && has_value)     { delta_settings.keyframe_interval = atoi(argv[++i]); }
+        else if (strcmp(arg, "-maxerror") == 0 && has_value)        { delta_settings.max_error = (float)atof(argv[++i]); }
+        else if (arg[0] != '-' && num_paths < 2)                    { paths[num_paths++] = arg; }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+    bool valid = delta_cache ?
+        num_paths >= 1 && delta_settings.keyframe_interval > 0 && delta_settings.max_error >= 0.0f :
+        num_paths == 2 && settings.frame_rate > 0.0f && settings.max_vertices > 0;
+    if (!valid) {
+        PrintUsage();
+        return 1;
+    }
+
+    aiContext *ctx = aiCreateContext();
+    if (!aiLoad(ctx, paths[0]) || aiIsBaked(ctx)) {
+        printf("failed to open %s as an Alembic archive\n", paths[0]);
+        aiDestroyContext(ctx);
+        return 1;
+    }
+
+    if (delta_cache) {
+        printf("writing the delta cache of %s\n", paths[0]);
+        bool ok = aiWriteDeltaCache(ctx, paths[1], &delta_settings);
+        aiDestroyContext(ctx);
+        if (!ok) {
+            printf("failed to write the delta cache\n");
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!has_start) { settings.start_time = aiGetStartTime(ctx); }
+    if (!has_end) { settings.end_time = aiGetEndTime(ctx); }
+
+    printf("baking %s (%.3f - %.3f, %.2f fps) into %s\n", paths[0], settings.start_time, settings.end_time, settings.frame_rate, paths[1]);
+    bool ok = aiBake(ctx, paths[1], &settings);
+    aiDestroyContext(ctx);
+    if (!ok) {
+        printf("failed to write %s\n", paths[1]);
+        return 1;
+    }
+    return 0;
+}
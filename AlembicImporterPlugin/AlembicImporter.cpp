@@ -3,6 +3,8 @@
 #include "aiGeometry.h"
 #include "aiObject.h"
 #include "aiContext.h"
+#include "aiBakedCache.h"
+#include "aiDeltaCache.h"
 
 #ifdef aiWindows
     #include <windows.h>
@@ -59,6 +61,66 @@ aiCLinkage aiExport void aiDestroyContext(aiContext* ctx)
 }
 
 
+aiCLinkage aiExport void aiSetNumReadStreams(aiContext* ctx, int n)
+{
+    aiCheckContext(ctx);
+    ctx->setNumReadStreams(n);
+}
+
+aiCLinkage aiExport void aiEnableMemoryMapping(aiContext* ctx, bool v)
+{
+    aiCheckContext(ctx);
+    ctx->enableMemoryMapping(v);
+}
+
+aiCLinkage aiExport void aiSetSampleCacheCapacity(aiContext* ctx, uint64_t bytes)
+{
+    aiCheckContext(ctx);
+    ctx->setSampleCacheCapacity(bytes);
+}
+
+aiCLinkage aiExport void aiSetPrefetchCapacity(aiContext* ctx, uint64_t bytes)
+{
+    aiCheckContext(ctx);
+    ctx->setPrefetchCapacity(bytes);
+}
+
+aiCLinkage aiExport void aiEnableDeltaCache(aiContext* ctx, bool v)
+{
+    aiCheckContext(ctx);
+    ctx->enableDeltaCache(v);
+}
+
+aiCLinkage aiExport void aiSetDeltaCacheDirectory(aiContext* ctx, const char *dir)
+{
+    aiCheckContext(ctx);
+    ctx->setDeltaCacheDirectory(dir);
+}
+
+aiCLinkage aiExport void aiEnableDeltaCacheWriting(aiContext* ctx, const aiDeltaCacheSettings *settings)
+{
+    aiCheckContext(ctx);
+    ctx->enableDeltaCacheWriting(settings);
+}
+
+aiCLinkage aiExport void aiEnableTrackPreload(aiContext* ctx, bool v)
+{
+    aiCheckContext(ctx);
+    ctx->enableTrackPreload(v);
+}
+
+aiCLinkage aiExport void aiEnableVisibilityCulling(aiContext* ctx, bool v)
+{
+    aiCheckContext(ctx);
+    ctx->enableVisibilityCulling(v);
+}
+
+aiCLinkage aiExport void aiEnableLazyHierarchy(aiContext* ctx, bool v)
+{
+    aiCheckContext(ctx);
+    ctx->enableLazyHierarchy(v);
+}
+
 aiCLinkage aiExport bool aiLoad(aiContext* ctx, const char *path)
 {
     aiCheckContext(ctx);
@@ -86,6 +148,68 @@ aiCLinkage aiExport aiObject* aiGetTopObject(aiContext* ctx)
     return ctx->getTopObject();
 }
 
+aiCLinkage aiExport int aiGetNumNodes(aiContext* ctx)
+{
+    aiCheckContext(ctx);
+    return ctx->getNumNodes();
+}
+
+aiCLinkage aiExport int aiGetTransforms(aiContext* ctx, aiM44 *world, aiM44 *local, int num_nodes)
+{
+    aiCheckContext(ctx);
+    static_assert(sizeof(aiM44) == sizeof(abcM44), "aiM44 and abcM44 must have the same layout");
+    return ctx->getTransforms((abcM44*)world, (abcM44*)local, num_nodes);
+}
+
+aiCLinkage aiExport int aiGetVisibilities(aiContext* ctx, bool *visible, int num_nodes)
+{
+    aiCheckContext(ctx);
+    return ctx->getVisibilities(visible, num_nodes);
+}
+
+aiCLinkage aiExport void aiUpdateSamples(aiContext* ctx, float time)
+{
+    aiCheckContext(ctx);
+    //aiDebugLogVerbose("aiUpdateSamples(): %.2f\n", time);
+    ctx->updateSamples(time);
+}
+
+aiCLinkage aiExport void aiWaitUpdate(aiContext* ctx)
+{
+    aiCheckContext(ctx);
+    ctx->waitUpdate();
+}
+
+aiCLinkage aiExport bool aiBake(aiContext* ctx, const char *path, const aiBakeSettings *settings)
+{
+    aiCheckContext(ctx);
+    aiDebugLog("aiBake(): %p %s\n", ctx, path);
+    return settings != nullptr && aiBakeContext(ctx, path, *settings);
+}
+
+aiCLinkage aiExport bool aiIsBaked(aiContext* ctx)
+{
+    aiCheckContext(ctx);
+    return ctx->getBakedCache() != nullptr;
+}
+
+aiCLinkage aiExport bool aiWriteDeltaCache(aiContext* ctx, const char *path, const aiDeltaCacheSettings *settings)
+{
+    aiCheckContext(ctx);
+    aiDebugLog("aiWriteDeltaCache(): %p %s\n", ctx, path);
+    if (settings == nullptr || ctx->getPath().empty()) { return false; }
+    // HDF5 archives can't be read by the update at the same time
+    ctx->waitUpdate();
+    std::string default_path = ctx->getDeltaCachePath();
+    return aiWriteDeltaCache(ctx, path ? path : default_path.c_str(), *settings);
+}
+
+aiCLinkage aiExport void aiPrefetchSamples(aiContext* ctx, const float *times, int num_times)
+{
+    aiCheckContext(ctx);
+    ctx->prefetchSamples(times, num_times);
+}
+
 
 aiCLinkage aiExport void aiEnumerateChild(aiObject *obj, aiNodeEnumerator e, void *userdata)
 {
@@ -130,6 +254,30 @@ aiCLinkage aiExport void aiEnableReverseIndex(aiObject* obj, bool v)
     obj->enableReverseIndex(v);
 }
 
+aiCLinkage aiExport void aiEnableShareVertices(aiObject* obj, bool v)
+{
+    aiCheckObject(obj);
+    obj->enableShareVertices(v);
+}
+
+aiCLinkage aiExport void aiEnableGenerateNormals(aiObject* obj, bool v)
+{
+    aiCheckObject(obj);
+    obj->enableGenerateNormals(v);
+}
+
+aiCLinkage aiExport void aiEnableGenerateTangents(aiObject* obj, bool v)
+{
+    aiCheckObject(obj);
+    obj->enableGenerateTangents(v);
+}
+
+aiCLinkage aiExport void aiSetSubframeMode(aiObject* obj, int mode)
+{
+    aiCheckObject(obj);
+    obj->setSubframeMode(mode);
+}
+
 
 
 aiCLinkage aiExport const char* aiGetNameS(aiObject* obj)
@@ -150,6 +298,19 @@ aiCLinkage aiExport uint32_t aiGetNumChildren(aiObject* obj)
     return obj->getNumChildren();
 }
 
+aiCLinkage aiExport int aiGetNodeID(aiObject* obj)
+{
+    aiCheckObject(obj);
+    return obj->getID();
+}
+
+aiCLinkage aiExport bool aiIsVisible(aiObject* obj)
+{
+    aiCheckObject(obj);
+    obj->getContext()->resolveVisibility();
+    return obj->isVisible();
+}
+
 
 aiCLinkage aiExport bool aiHasXForm(aiObject* obj)
 {
@@ -157,6 +318,12 @@ aiCLinkage aiExport bool aiHasXForm(aiObject* obj)
     return obj->hasXForm();
 }
 
+aiCLinkage aiExport bool aiXFormIsDirty(aiObject* obj)
+{
+    aiCheckObject(obj);
+    return obj->getXForm().isDirty();
+}
+
 aiCLinkage aiExport bool aiXFormGetInherits(aiObject* obj)
 {
     aiCheckObject(obj);
@@ -236,6 +403,18 @@ aiCLinkage aiExport bool aiPolyMeshHasUVs(aiObject* obj)
     return obj->getPolyMesh().hasUVs();
 }
 
+aiCLinkage aiExport bool aiPolyMeshHasTangents(aiObject* obj)
+{
+    aiCheckObject(obj);
+    return obj->getPolyMesh().hasTangents();
+}
+
+aiCLinkage aiExport int aiPolyMeshGetDirtyFlags(aiObject* obj)
+{
+    aiCheckObject(obj);
+    return obj->getPolyMesh().getDirtyFlags();
+}
+
 
 aiCLinkage aiExport uint32_t aiPolyMeshGetIndexCount(aiObject* obj)
 {
@@ -303,6 +482,48 @@ aiCLinkage aiExport void aiPolyMeshCopySplitedUVs(aiObject* obj, abcV2 *dst, con
     return obj->getPolyMesh().copySplitedUVs(dst, *smi);
 }
 
+aiCLinkage aiExport void aiPolyMeshCopySplitedTangents(aiObject* obj, abcV4 *dst, const aiSplitedMeshInfo *smi)
+{
+    aiCheckObject(obj);
+    return obj->getPolyMesh().copySplitedTangents(dst, *smi);
+}
+
+aiCLinkage aiExport void aiPolyMeshCopySplitedAttribute(aiObject* obj, void *dst, const aiSplitedMeshInfo *smi, int attribute, int format)
+{
+    aiCheckObject(obj);
+    return obj->getPolyMesh().copySplitedAttribute(dst, *smi, attribute, format);
+}
+
+aiCLinkage aiExport void aiPolyMeshGetQuantizationParams(aiObject* obj, aiQuantizationParams *o_params)
+{
+    aiCheckObject(obj);
+    *o_params = obj->getPolyMesh().getQuantizationParams();
+}
+
+aiCLinkage aiExport void aiPolyMeshCopyDataToTexture(aiObject* obj, aiTextureMeshData *dst)
+{
+    aiCheckObject(obj);
+    return obj->getPolyMesh().copyDataToTexture(*dst);
+}
+
+aiCLinkage aiExport void aiPolyMeshSetOutputBuffer(aiObject* obj, int split, int attribute, void *dst, int capacity)
+{
+    aiCheckObject(obj);
+    return obj->getPolyMesh().setOutputBuffer(split, attribute, dst, capacity);
+}
+
+aiCLinkage aiExport void aiPolyMeshSetOutputFormat(aiObject* obj, int attribute, int format)
+{
+    aiCheckObject(obj);
+    return obj->getPolyMesh().setOutputFormat(attribute, format);
+}
+
+aiCLinkage aiExport void aiPolyMeshWriteOutputBuffers(aiObject* obj, aiMeshOutputResult *o_result, int max_vertices)
+{
+    aiCheckObject(obj);
+    return obj->getPolyMesh().writeOutputBuffers(*o_result, max_vertices);
+}
+
 
 aiCLinkage aiExport bool aiHasCurves(aiObject* obj)
 {
@@ -310,6 +531,42 @@ aiCLinkage aiExport bool aiHasCurves(aiObject* obj)
     return obj->hasCurves();
 }
 
+aiCLinkage aiExport int aiCurvesGetDirtyFlags(aiObject* obj)
+{
+    aiCheckObject(obj);
+    return obj->getCurves().getDirtyFlags();
+}
+
+aiCLinkage aiExport int aiCurvesGetNumCurves(aiObject* obj)
+{
+    aiCheckObject(obj);
+    return obj->getCurves().getNumCurves();
+}
+
+aiCLinkage aiExport int aiCurvesGetVertexCount(aiObject* obj)
+{
+    aiCheckObject(obj);
+    return obj->getCurves().getVertexCount();
+}
+
+aiCLinkage aiExport bool aiCurvesHasWidths(aiObject* obj)
+{
+    aiCheckObject(obj);
+    return obj->getCurves().hasWidths();
+}
+
+aiCLinkage aiExport int aiCurvesGetSplits(aiObject* obj, aiCurvesSplitInfo *dst, int max_splits, int max_vertices)
+{
+    aiCheckObject(obj);
+    return obj->getCurves().getSplits(dst, max_splits, max_vertices);
+}
+
+aiCLinkage aiExport void aiCurvesCopySplitData(aiObject* obj, aiCurvesData *dst, const aiCurvesSplitInfo *split)
+{
+    aiCheckObject(obj);
+    obj->getCurves().copySplitData(*dst, *split);
+}
+
 
 aiCLinkage aiExport bool aiHasPoints(aiObject* obj)
 {
@@ -317,6 +574,36 @@ aiCLinkage aiExport bool aiHasPoints(aiObject* obj)
     return obj->hasPoints();
 }
 
+aiCLinkage aiExport void aiPointsEnableSort(aiObject* obj, bool v)
+{
+    aiCheckObject(obj);
+    obj->getPoints().enableSort(v);
+}
+
+aiCLinkage aiExport bool aiPointsHasVelocities(aiObject* obj)
+{
+    aiCheckObject(obj);
+    return obj->getPoints().hasVelocities();
+}
+
+aiCLinkage aiExport int aiPointsGetDirtyFlags(aiObject* obj)
+{
+    aiCheckObject(obj);
+    return obj->getPoints().getDirtyFlags();
+}
+
+aiCLinkage aiExport int aiPointsGetCount(aiObject* obj)
+{
+    aiCheckObject(obj);
+    return obj->getPoints().getCount();
+}
+
+aiCLinkage aiExport bool aiPointsCopyData(aiObject* obj, aiPointsData *data)
+{
+    aiCheckObject(obj);
+    return obj->getPoints().copyData(*data);
+}
+
 
 aiCLinkage aiExport bool aiHasCamera(aiObject* obj)
 {
@@ -19,6 +19,62 @@ struct aiV3 { float v[3]; };
 struct aiM44 { float v[4][4]; };
 
 
+enum aiMeshProperty
+{
+    aiMeshProperty_Indices      = 1 << 0,
+    aiMeshProperty_Counts       = 1 << 1,
+    aiMeshProperty_Positions    = 1 << 2,
+    aiMeshProperty_Velocities   = 1 << 3,
+    aiMeshProperty_Normals      = 1 << 4,
+    aiMeshProperty_UVs          = 1 << 5,
+    aiMeshProperty_Tangents     = 1 << 6,
+
+    aiMeshProperty_Topology     = aiMeshProperty_Indices | aiMeshProperty_Counts,
+};
+
+enum aiCurvesProperty
+{
+    aiCurvesProperty_Positions  = 1 << 0,
+    aiCurvesProperty_Counts     = 1 << 1, // number of vertices of each curve, or whether they are closed
+    aiCurvesProperty_Widths     = 1 << 2,
+};
+
+enum aiPointsProperty
+{
+    aiPointsProperty_Positions  = 1 << 0,
+    aiPointsProperty_Velocities = 1 << 1,
+    aiPointsProperty_IDs        = 1 << 2,
+};
+
+
+// how samples are evaluated at times between them
+enum aiSubframeMode
+{
+    aiSubframeMode_Nearest,     // the nearest sample as is
+    aiSubframeMode_Velocity,    // positions of the preceding sample moved by its velocities. meshes with velocities only
+    aiSubframeMode_Linear,      // blend of the samples before and after. transforms, and meshes whose topology doesn't change
+};
+
+// compact encodings of split vertex attributes, to cut upload bandwidth and memory
+enum aiVertexFormat
+{
+    aiVertexFormat_Float,       // abcV3 positions and normals, abcV2 uvs, like the aiPolyMeshCopySplited*() functions write
+    aiVertexFormat_Half4,       // positions: x, y, z, 1 as half floats. 8 bytes
+    aiVertexFormat_UNorm16x4,   // positions: x, y, z, 1 as unorm16 relative to the mesh bounds. 8 bytes
+    aiVertexFormat_Oct16,       // normals: octahedral, 2 snorm16. 4 bytes
+    aiVertexFormat_UNorm16x2,   // uvs: unorm16 relative to the uv bounds. 4 bytes
+};
+
+// to decode the bounds relative formats of the current sample: value = unorm * scale + offset, with unorm in [0, 1].
+// bounds are of the whole mesh, after reverse-X
+struct aiQuantizationParams
+{
+    abcV3 position_offset;
+    abcV3 position_scale;
+    abcV2 uv_offset;
+    abcV2 uv_scale;
+};
+
 struct aiSplitedMeshInfo
 {
     int num_faces;
@@ -29,25 +85,95 @@ struct aiSplitedMeshInfo
     int triangulated_index_count;
 };
 
+// how aiBake() evaluates the archive. triangulation, splits and generated attributes are made once and for all with
+// these, while reverse-X is still applied on playback
+struct aiBakeSettings
+{
+    float start_time;
+    float end_time;
+    float frame_rate;       // frames are sampled at this rate from start_time to end_time
+    int max_vertices;       // of each split
+    int subframe_mode;      // aiSubframeMode of the frames between samples
+    bool reverse_index;
+    bool share_vertices;
+    bool generate_normals;
+    bool generate_tangents;
+};
+
+// how aiWriteDeltaCache() encodes positions of constant topology meshes
+struct aiDeltaCacheSettings
+{
+    int keyframe_interval;  // at most this many samples from one keyframe to the next
+    // largest error allowed, in units of the archive. samples that would be less precise with 16 bit deltas become
+    // keyframes, and those precise enough with 8 bit deltas get them. 0: lossless, only deltas that decode back to
+    // exactly the same positions
+    float max_error;
+};
+
 
 aiCLinkage aiExport aiContext*      aiCreateContext();
 aiCLinkage aiExport void            aiDestroyContext(aiContext* ctx);
 
+aiCLinkage aiExport void            aiSetNumReadStreams(aiContext* ctx, int n); // must be called before aiLoad()
+aiCLinkage aiExport void            aiEnableMemoryMapping(aiContext* ctx, bool v); // must be called before aiLoad(). needs the patched Ogawa
+aiCLinkage aiExport void            aiSetSampleCacheCapacity(aiContext* ctx, uint64_t bytes); // must be called before aiLoad(). 0: no cache. needs the patched Ogawa
+aiCLinkage aiExport void            aiSetPrefetchCapacity(aiContext* ctx, uint64_t bytes); // 0: no prefetch. Ogawa archives only
+// must be called before aiLoad(). positions of constant topology meshes are decoded from the delta cache of the
+// archive (its file name + ".delta"), next to it or in the directory given to aiSetDeltaCacheDirectory()
+aiCLinkage aiExport void            aiEnableDeltaCache(aiContext* ctx, bool v);
+aiCLinkage aiExport void            aiSetDeltaCacheDirectory(aiContext* ctx, const char *dir); // must be called before aiLoad(). null: next to the archive
+// must be called before aiLoad(). with the delta cache enabled, if the archive has none (or an out of date one), it is
+// written with settings in the background after aiLoad() for the next time. Ogawa archives only. null: never (default)
+aiCLinkage aiExport void            aiEnableDeltaCacheWriting(aiContext* ctx, const aiDeltaCacheSettings *settings);
+// must be called before aiLoad(). xform, camera and visibility samples of the whole time range are read at load, or by
+// the first update of objects a lazy hierarchy makes later
+aiCLinkage aiExport void            aiEnableTrackPreload(aiContext* ctx, bool v);
+// aiUpdateSamples() skips hidden nodes and their whole subtrees, so their data stays as it was last read
+aiCLinkage aiExport void            aiEnableVisibilityCulling(aiContext* ctx, bool v);
+// must be called before aiLoad(). only the top object is made at load, the others when they are first enumerated, so
+// that opening huge archives costs what is actually used. aiGetNumNodes() counts the objects made so far. objects made
+// after an update are read by the next aiUpdateSamples()
+aiCLinkage aiExport void            aiEnableLazyHierarchy(aiContext* ctx, bool v);
 aiCLinkage aiExport bool            aiLoad(aiContext* ctx, const char *path);
 aiCLinkage aiExport float           aiGetStartTime(aiContext* ctx);
 aiCLinkage aiExport float           aiGetEndTime(aiContext* ctx);
 aiCLinkage aiExport aiObject*       aiGetTopObject(aiContext* ctx);
+aiCLinkage aiExport int             aiGetNumNodes(aiContext* ctx);
+// world and local matrices of all nodes indexed by aiGetNodeID(). either may be null. returns number of nodes written
+aiCLinkage aiExport int             aiGetTransforms(aiContext* ctx, aiM44 *world, aiM44 *local, int num_nodes);
+// visibility of all nodes at the time of the last aiUpdateSamples(), indexed by aiGetNodeID(). a node is hidden if its
+// visibility property or the one of any of its ancestors says so. returns number of nodes written
+aiCLinkage aiExport int             aiGetVisibilities(aiContext* ctx, bool *visible, int num_nodes);
+aiCLinkage aiExport void            aiUpdateSamples(aiContext* ctx, float time);
+aiCLinkage aiExport void            aiWaitUpdate(aiContext* ctx);
+aiCLinkage aiExport void            aiPrefetchSamples(aiContext* ctx, const float *times, int num_times); // call after aiUpdateSamples()
+// writes every frame of the loaded archive to a baked cache file, which aiLoad() plays back with next to no work per frame.
+// the archive is read through a context of its own, which leaves ctx and its nodes as they are
+aiCLinkage aiExport bool            aiBake(aiContext* ctx, const char *path, const aiBakeSettings *settings);
+aiCLinkage aiExport bool            aiIsBaked(aiContext* ctx); // true if the loaded file is a baked cache
+// writes the delta cache of the loaded archive to path, or where aiEnableDeltaCache() looks for it if path is null
+aiCLinkage aiExport bool            aiWriteDeltaCache(aiContext* ctx, const char *path, const aiDeltaCacheSettings *settings);
 
 aiCLinkage aiExport void            aiEnumerateChild(aiObject *obj, aiNodeEnumerator e, void *userdata);
 aiCLinkage aiExport const char*     aiGetNameS(aiObject* obj);
 aiCLinkage aiExport const char*     aiGetFullNameS(aiObject* obj);
 aiCLinkage aiExport uint32_t        aiGetNumChildren(aiObject* obj);
+aiCLinkage aiExport int             aiGetNodeID(aiObject* obj);
+aiCLinkage aiExport bool            aiIsVisible(aiObject* obj); // see aiGetVisibilities()
 aiCLinkage aiExport void            aiSetCurrentTime(aiObject* obj, float time);
 aiCLinkage aiExport void            aiEnableReverseX(aiObject* obj, bool v);
 aiCLinkage aiExport void            aiEnableTriangulate(aiObject* obj, bool v);
 aiCLinkage aiExport void            aiEnableReverseIndex(aiObject* obj, bool v);
+// split meshes weld face corners that share position, normal and uv, instead of emitting a vertex per corner
+aiCLinkage aiExport void            aiEnableShareVertices(aiObject* obj, bool v);
+// meshes without normals get smooth normals computed from their positions. aiPolyMeshHasNormals() is true for them
+aiCLinkage aiExport void            aiEnableGenerateNormals(aiObject* obj, bool v);
+// meshes with normals and uvs get tangents, with the handedness of the bitangent in w
+aiCLinkage aiExport void            aiEnableGenerateTangents(aiObject* obj, bool v);
+aiCLinkage aiExport void            aiSetSubframeMode(aiObject* obj, int mode); // aiSubframeMode
 
 aiCLinkage aiExport bool            aiHasXForm(aiObject* obj);
+aiCLinkage aiExport bool            aiXFormIsDirty(aiObject* obj);
 aiCLinkage aiExport bool            aiXFormGetInherits(aiObject* obj);
 aiCLinkage aiExport aiV3            aiXFormGetPosition(aiObject* obj);
 aiCLinkage aiExport aiV3            aiXFormGetAxis(aiObject* obj);
@@ -61,6 +187,8 @@ aiCLinkage aiExport bool            aiPolyMeshIsTopologyConstant(aiObject* obj);
 aiCLinkage aiExport bool            aiPolyMeshIsTopologyConstantTriangles(aiObject* obj);
 aiCLinkage aiExport bool            aiPolyMeshHasNormals(aiObject* obj);
 aiCLinkage aiExport bool            aiPolyMeshHasUVs(aiObject* obj);
+aiCLinkage aiExport bool            aiPolyMeshHasTangents(aiObject* obj);
+aiCLinkage aiExport int             aiPolyMeshGetDirtyFlags(aiObject* obj); // aiMeshProperty flags of the data changed by the last sample update
 aiCLinkage aiExport uint32_t        aiPolyMeshGetIndexCount(aiObject* obj);
 aiCLinkage aiExport uint32_t        aiPolyMeshGetVertexCount(aiObject* obj);
 aiCLinkage aiExport void            aiPolyMeshCopyIndices(aiObject* obj, int *dst);
@@ -72,7 +200,15 @@ aiCLinkage aiExport void            aiPolyMeshCopySplitedIndices(aiObject* obj,
 aiCLinkage aiExport void            aiPolyMeshCopySplitedVertices(aiObject* obj, abcV3 *dst, const aiSplitedMeshInfo *smi);
 aiCLinkage aiExport void            aiPolyMeshCopySplitedNormals(aiObject* obj, abcV3 *dst, const aiSplitedMeshInfo *smi);
 aiCLinkage aiExport void            aiPolyMeshCopySplitedUVs(aiObject* obj, abcV2 *dst, const aiSplitedMeshInfo *smi);
+aiCLinkage aiExport void            aiPolyMeshCopySplitedTangents(aiObject* obj, abcV4 *dst, const aiSplitedMeshInfo *smi);
+// attribute is aiMeshProperty_Positions, _Normals or _UVs, format an aiVertexFormat of it
+aiCLinkage aiExport void            aiPolyMeshCopySplitedAttribute(aiObject* obj, void *dst, const aiSplitedMeshInfo *smi, int attribute, int format);
+aiCLinkage aiExport void            aiPolyMeshGetQuantizationParams(aiObject* obj, aiQuantizationParams *o_params);
 
+// vertex textures are aiTextureWidth float4 texels wide. one texel per element:
+// indices: (position index, normal index, uv index, 0) of each triangulated face corner
+// vertices: (x, y, z, 1), normals: (x, y, z, 0), uvs: (u, v, 0, 0)
+const int aiTextureWidth = 1024;
 struct aiTextureMeshData
 {
     int num_indices;
@@ -85,10 +221,82 @@ struct aiTextureMeshData
 };
 aiCLinkage aiExport void            aiPolyMeshCopyDataToTexture(aiObject* obj, aiTextureMeshData *dst);
 
+// persistent output buffers. the caller registers the destination of each attribute of each split once, and
+// aiPolyMeshWriteOutputBuffers() writes whatever changed into them, in place of the aiPolyMeshCopySplited*() calls.
+// attribute is one of aiMeshProperty_Indices, _Positions, _Normals, _UVs and _Tangents, capacity is in elements
+// (int, abcV3, abcV3, abcV2 and abcV4). dst == nullptr unregisters. a buffer that has just been registered is
+// written in full on the next write.
+// once aiPolyMeshWriteOutputBuffers() has been called, the buffers are written by the update tasks started by
+// aiUpdateSamples(), and it only returns what they wrote. they must not be touched until aiWaitUpdate().
+struct aiMeshSplitCounts
+{
+    int index_count;
+    int vertex_count;
+    int written_flags;          // aiMeshProperty flags of the buffers written
+};
+struct aiMeshOutputResult
+{
+    int dirty_flags;            // aiPolyMeshGetDirtyFlags()
+    int num_splits;
+    int num_too_small;          // registered buffers skipped because they are smaller than their split's counts
+    int max_splits;             // in: number of elements of split_counts. if less than num_splits, nothing is written
+    aiMeshSplitCounts *split_counts; // in: caller owned
+    aiQuantizationParams quantization;
+};
+aiCLinkage aiExport void            aiPolyMeshSetOutputBuffer(aiObject* obj, int split, int attribute, void *dst, int capacity);
+// aiVertexFormat the buffers of attribute are written in. aiVertexFormat_Float by default
+aiCLinkage aiExport void            aiPolyMeshSetOutputFormat(aiObject* obj, int attribute, int format);
+aiCLinkage aiExport void            aiPolyMeshWriteOutputBuffers(aiObject* obj, aiMeshOutputResult *o_result, int max_vertices);
+
 
 aiCLinkage aiExport bool            aiHasCurves(aiObject* obj);
+aiCLinkage aiExport int             aiCurvesGetDirtyFlags(aiObject* obj); // aiCurvesProperty flags of the data changed by the last sample update
+aiCLinkage aiExport int             aiCurvesGetNumCurves(aiObject* obj);
+aiCLinkage aiExport int             aiCurvesGetVertexCount(aiObject* obj);
+aiCLinkage aiExport bool            aiCurvesHasWidths(aiObject* obj);
+// curves are drawn as line lists through their vertices, cubic ones through their control points. they are split
+// into groups of whole curves of at most max_vertices vertices, except that a longer curve gets a split of its own.
+// splits and indices are made once as long as the number of vertices of the curves doesn't change
+struct aiCurvesSplitInfo
+{
+    int begin_curve;
+    int num_curves;
+    int begin_vertex;
+    int num_vertices;
+    int begin_index;
+    int num_indices;        // 2 per segment. closed curves have a segment from the last vertex to the first
+};
+// destinations of aiCurvesCopySplitData(). any of them may be null
+struct aiCurvesData
+{
+    abcV3 *positions;       // num_vertices of the split
+    float *widths;          // num_vertices, whether the sample has a width per vertex, per curve or one for all. zeros if none
+    int *indices;           // num_indices, relative to the first vertex of the split
+    int *curve_offsets;     // num_curves, first vertex of each curve relative to the first vertex of the split
+    int *curve_counts;      // num_curves, number of vertices of each curve
+};
+// writes min(number of splits, max_splits) splits to dst and returns the number of splits. dst may be null
+aiCLinkage aiExport int             aiCurvesGetSplits(aiObject* obj, aiCurvesSplitInfo *dst, int max_splits, int max_vertices);
+aiCLinkage aiExport void            aiCurvesCopySplitData(aiObject* obj, aiCurvesData *dst, const aiCurvesSplitInfo *split);
 
 aiCLinkage aiExport bool            aiHasPoints(aiObject* obj);
+// points in ascending id order instead of sample order, so that a point keeps its place across samples as long as
+// no point with a smaller id is born or dies. off by default
+aiCLinkage aiExport void            aiPointsEnableSort(aiObject* obj, bool v);
+aiCLinkage aiExport bool            aiPointsHasVelocities(aiObject* obj);
+aiCLinkage aiExport int             aiPointsGetDirtyFlags(aiObject* obj); // aiPointsProperty flags of the data changed by the last sample update
+aiCLinkage aiExport int             aiPointsGetCount(aiObject* obj);
+// all points of the current sample in one call, as separate arrays. any of them may be null
+struct aiPointsData
+{
+    abcV3 *positions;
+    abcV3 *velocities;      // zeros if the sample has none
+    uint64_t *ids;          // the index in the sample if the sample has none
+    int capacity;           // in: number of elements each array can hold
+    int num_points;         // out: aiPointsGetCount(), even if capacity is too small
+};
+// false, writing nothing, if capacity is less than the number of points
+aiCLinkage aiExport bool            aiPointsCopyData(aiObject* obj, aiPointsData *data);
 
 aiCLinkage aiExport bool            aiHasCamera(aiObject* obj);
 aiCLinkage aiExport void            aiCameraGetParams(aiObject* obj, aiCameraParams *o_params);
@@ -0,0 +1,417 @@
+﻿#include "pch.h"
+#include "AlembicImporter.h"
+#include "aiGeometry.h"
+#include "aiObject.h"
+#include "aiContext.h"
+#include "aiBakedCache.h"
+#include <fstream>
+
+
+static uint64_t aiAlign16(uint64_t v)
+{
+    return (v + 15) & ~uint64_t(15);
+}
+
+
+bool aiBakedCache::isBakedCache(const char *path)
+{
+    std::ifstream is(path, std::ios::binary);
+    uint32_t magic = 0;
+    is.read((char*)&magic, sizeof(magic));
+    return is.good() && magic == aiBakedMagic;
+}
+
+aiBakedCache::aiBakedCache()
+    : m_data(nullptr)
+    , m_size(0)
+{
+}
+
+aiBakedCache::~aiBakedCache()
+{
+    close();
+}
+
+bool aiBakedCache::open(const char *path)
+{
+    close();
+    if (!m_file.open(path)) { return false; }
+    m_data = m_file.getData();
+    m_size = m_file.getSize();
+
+    if (!validate()) {
+        aiDebugLog("aiBakedCache::open(): %s is not a valid baked cache\n", path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void aiBakedCache::close()
+{
+    m_file.close();
+    m_data = nullptr;
+    m_size = 0;
+}
+
+bool aiBakedCache::contains(uint64_t offset, uint64_t size) const
+{
+    return offset <= m_size && size <= m_size - offset;
+}
+
+bool aiBakedCache::validate() const
+{
+    if (!contains(0, sizeof(aiBakedHeader))) { return false; }
+    const aiBakedHeader &h = getHeader();
+    if (h.magic != aiBakedMagic || h.version != aiBakedVersion || h.num_frames == 0 || !(h.frame_rate > 0.0f)) {
+        return false;
+    }
+    if (!contains(h.nodes, sizeof(aiBakedNode) * h.num_nodes) ||
+        !contains(h.meshes, sizeof(aiBakedMesh) * h.num_meshes) ||
+        !contains(h.frames, sizeof(aiBakedFrame) * h.num_frames) ||
+        h.strings > h.frames)
+    {
+        return false;
+    }
+
+    const char *strings = m_data + h.strings;
+    size_t strings_size = size_t(h.frames - h.strings);
+    auto valid_string = [&](uint32_t o) {
+        return o < strings_size && memchr(strings + o, '\0', strings_size - o) != nullptr;
+    };
+    for (uint32_t i = 0; i < h.num_nodes; ++i) {
+        const aiBakedNode &n = getNode(i);
+        if (n.parent < -1 || n.parent >= (int32_t)i ||
+            n.xform < -1 || n.xform >= (int32_t)h.num_xforms ||
+            n.mesh < -1 || n.mesh >= (int32_t)h.num_meshes ||
+            n.visibility < -1 || n.visibility >= (int32_t)h.num_visibilities ||
+            !valid_string(n.name) || !valid_string(n.full_name))
+        {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < h.num_meshes; ++i) {
+        const aiBakedMesh &m = getMesh(i);
+        if (m.node < 0 || m.node >= (int32_t)h.num_nodes) { return false; }
+    }
+
+    uint64_t header_size = sizeof(abcM44) * h.num_xforms + sizeof(aiBakedMeshFrame) * h.num_meshes + h.num_visibilities;
+    auto valid_array = [&](uint64_t offset, uint64_t size) {
+        return size == 0 || (offset != 0 && contains(offset, size));
+    };
+    auto valid_attribute = [&](uint64_t offset, uint64_t size) {
+        return offset == 0 || contains(offset, size);
+    };
+    const aiBakedFrame *frames = get<aiBakedFrame>(h.frames);
+    for (uint32_t fi = 0; fi < h.num_frames; ++fi) {
+        if (frames[fi].size < header_size || !contains(frames[fi].offset, frames[fi].size)) { return false; }
+
+        for (uint32_t mi = 0; mi < h.num_meshes; ++mi) {
+            const aiBakedMeshFrame &mf = getMeshFrame(fi, mi);
+            if (!valid_array(mf.splits, sizeof(aiSplitedMeshInfo) * mf.num_splits) ||
+                !valid_array(mf.indices, sizeof(int) * mf.num_indices) ||
+                !valid_array(mf.positions, sizeof(abcV3) * mf.num_vertices) ||
+                !valid_attribute(mf.normals, sizeof(abcV3) * mf.num_vertices) ||
+                !valid_attribute(mf.uvs, sizeof(abcV2) * mf.num_vertices) ||
+                !valid_attribute(mf.tangents, sizeof(abcV4) * mf.num_vertices))
+            {
+                return false;
+            }
+
+            // the splits must add up to the arrays
+            const aiSplitedMeshInfo *splits = get<aiSplitedMeshInfo>(mf.splits);
+            uint64_t num_indices = 0, num_vertices = 0;
+            for (uint32_t si = 0; si < mf.num_splits; ++si) {
+                if (splits[si].triangulated_index_count < 0 || splits[si].num_vertices < 0) { return false; }
+                num_indices += splits[si].triangulated_index_count;
+                num_vertices += splits[si].num_vertices;
+            }
+            if (num_indices != mf.num_indices || num_vertices != mf.num_vertices) { return false; }
+        }
+    }
+    return true;
+}
+
+const aiBakedHeader& aiBakedCache::getHeader() const
+{
+    return *(const aiBakedHeader*)m_data;
+}
+
+const aiBakedNode& aiBakedCache::getNode(int i) const
+{
+    return get<aiBakedNode>(getHeader().nodes)[i];
+}
+
+const aiBakedMesh& aiBakedCache::getMesh(int i) const
+{
+    return get<aiBakedMesh>(getHeader().meshes)[i];
+}
+
+const char* aiBakedCache::getString(uint32_t offset) const
+{
+    return m_data + getHeader().strings + offset;
+}
+
+int aiBakedCache::getFrame(float time) const
+{
+    const aiBakedHeader &h = getHeader();
+    float f = (time - h.start_time) * h.frame_rate + 0.5f;
+    f = std::max<float>(f, 0.0f);
+    f = std::min<float>(f, float(h.num_frames - 1));
+    return (int)f;
+}
+
+float aiBakedCache::getFrameTime(int frame) const
+{
+    return get<aiBakedFrame>(getHeader().frames)[frame].time;
+}
+
+const abcM44& aiBakedCache::getLocal(int frame, int xform) const
+{
+    const aiBakedFrame &f = get<aiBakedFrame>(getHeader().frames)[frame];
+    return get<abcM44>(f.offset)[xform];
+}
+
+const aiBakedMeshFrame& aiBakedCache::getMeshFrame(int frame, int mesh) const
+{
+    const aiBakedHeader &h = getHeader();
+    const aiBakedFrame &f = get<aiBakedFrame>(h.frames)[frame];
+    return get<aiBakedMeshFrame>(f.offset + sizeof(abcM44) * h.num_xforms)[mesh];
+}
+
+int8_t aiBakedCache::getVisibility(int frame, int visibility) const
+{
+    const aiBakedHeader &h = getHeader();
+    const aiBakedFrame &f = get<aiBakedFrame>(h.frames)[frame];
+    return get<int8_t>(f.offset + sizeof(abcM44) * h.num_xforms + sizeof(aiBakedMeshFrame) * h.num_meshes)[visibility];
+}
+
+
+
+// appends data to the frame block at a 16 byte boundary. returns its offset in the file, 0 if there is no data
+template<class T>
+static uint64_t aiAppendFrameData(std::vector<char> &block, uint64_t block_offset, const std::vector<T> &data)
+{
+    if (data.empty()) { return 0; }
+
+    size_t pos = block.size();
+    size_t size = sizeof(T) * data.size();
+    block.resize(pos + (size_t)aiAlign16(size), 0);
+    memcpy(&block[pos], data.data(), size);
+    return block_offset + pos;
+}
+
+// all splits of the current topology of mesh
+static void aiGetSplits(const aiPolyMesh &mesh, int max_vertices, std::vector<aiSplitedMeshInfo> &dst)
+{
+    dst.clear();
+    aiSplitedMeshInfo smi, prev = {};
+    for (bool last = false; !last; prev = smi) {
+        last = mesh.getSplitedMeshInfo(smi, prev, max_vertices);
+        dst.push_back(smi);
+    }
+}
+
+// splits of all vertices into dst, back to back
+template<class T, class F>
+static void aiGatherSplitData(std::vector<T> &dst, const std::vector<aiSplitedMeshInfo> &splits, uint32_t num_vertices, const F &copy)
+{
+    dst.resize(num_vertices);
+    size_t offset = 0;
+    for (const auto &smi : splits) {
+        if (smi.num_vertices > 0) { copy(&dst[offset], smi); }
+        offset += smi.num_vertices;
+    }
+}
+
+bool aiBakeContext(aiContext *src, const char *path, const aiBakeSettings &settings)
+{
+    if (path == nullptr || src->getBakedCache() != nullptr || !(settings.frame_rate > 0.0f) || settings.max_vertices <= 0) {
+        return false;
+    }
+
+    // evaluated by a context of its own on the same archive, which is set up and moved through time as the bake needs
+    // while the options, time and output buffers of src stay as they are. the update of src is done first, as HDF5
+    // archives can't be read by both at once
+    src->waitUpdate();
+    std::unique_ptr<aiContext> ctx(aiContext::create());
+    if (!ctx->load(src->getPath().c_str())) { return false; }
+    int num_nodes = ctx->getNumNodes();
+    if (num_nodes == 0) { return false; }
+
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    if (!os) { return false; }
+
+    aiBakedHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = aiBakedMagic;
+    header.version = aiBakedVersion;
+    header.num_nodes = num_nodes;
+    header.start_time = settings.start_time;
+    header.frame_rate = settings.frame_rate;
+    float duration = std::max<float>(settings.end_time - settings.start_time, 0.0f);
+    header.num_frames = uint32_t(duration * settings.frame_rate + 0.5f) + 1;
+
+    // evaluate in the space of the archive. reverse-X is left to playback, like with archives.
+    // hidden meshes are baked too, as playback decides what is hidden: the context doesn't cull
+    std::vector<aiBakedNode> nodes(num_nodes);
+    std::vector<aiBakedMesh> meshes;
+    std::vector<aiPolyMesh*> polymeshes;
+    std::string strings;
+    for (int i = 0; i < num_nodes; ++i) {
+        aiObject *obj = ctx->getNode(i);
+        obj->enableReverseX(false);
+        obj->enableTriangulate(true);
+        obj->enableReverseIndex(settings.reverse_index);
+        obj->enableShareVertices(settings.share_vertices);
+        obj->enableGenerateNormals(settings.generate_normals);
+        obj->enableGenerateTangents(settings.generate_tangents);
+        obj->setSubframeMode(settings.subframe_mode);
+
+        aiBakedNode &bn = nodes[i];
+        bn.parent = obj->getParent() ? obj->getParent()->getID() : -1;
+        bn.xform = obj->hasXForm() ? (int32_t)header.num_xforms++ : -1;
+        bn.mesh = -1;
+        bn.visibility = obj->hasVisibility() ? (int32_t)header.num_visibilities++ : -1;
+        if (obj->hasPolyMesh()) {
+            aiBakedMesh bm = { i, 0, 1, settings.max_vertices };
+            bn.mesh = (int32_t)meshes.size();
+            meshes.push_back(bm);
+            polymeshes.push_back(&obj->getPolyMesh());
+        }
+        bn.name = (uint32_t)strings.size();
+        strings.append(obj->getName()).push_back('\0');
+        bn.full_name = (uint32_t)strings.size();
+        strings.append(obj->getFullName()).push_back('\0');
+    }
+    header.num_meshes = (uint32_t)meshes.size();
+    header.nodes = aiAlign16(sizeof(aiBakedHeader));
+    header.meshes = aiAlign16(header.nodes + sizeof(aiBakedNode) * nodes.size());
+    header.strings = aiAlign16(header.meshes + sizeof(aiBakedMesh) * meshes.size());
+    header.frames = aiAlign16(header.strings + strings.size());
+
+    // the tables in front of the frames are complete only after the last frame. until then zeros hold their place
+    std::vector<char> tables((size_t)aiAlign16(header.frames + sizeof(aiBakedFrame) * header.num_frames), 0);
+    os.write(tables.data(), tables.size());
+
+    std::vector<aiBakedFrame> frames(header.num_frames);
+    std::vector<aiBakedMeshFrame> mesh_frames(meshes.size()); // of the previous frame until they are updated
+    std::vector<std::vector<aiSplitedMeshInfo>> mesh_splits(meshes.size());
+    std::vector<aiSplitedMeshInfo> new_splits;
+    std::vector<abcM44> locals(num_nodes);
+    std::vector<int> indices;
+    std::vector<abcV2> v2;
+    std::vector<abcV3> v3;
+    std::vector<abcV4> v4;
+    std::vector<char> block;
+    uint64_t offset = tables.size();
+    size_t visibilities_offset = sizeof(abcM44) * header.num_xforms + sizeof(aiBakedMeshFrame) * meshes.size();
+    size_t block_header_size = visibilities_offset + header.num_visibilities;
+
+    for (uint32_t fi = 0; fi < header.num_frames; ++fi) {
+        float time = settings.start_time + float(fi) / settings.frame_rate;
+        ctx->updateSamples(time);
+        ctx->getTransforms(nullptr, locals.data(), num_nodes);
+        ctx->resolveVisibility();
+
+        block.assign((size_t)aiAlign16(block_header_size), 0);
+        abcM44 *block_locals = (abcM44*)block.data();
+        int8_t *block_visibilities = (int8_t*)&block[visibilities_offset];
+        for (int i = 0; i < num_nodes; ++i) {
+            if (nodes[i].xform >= 0) { block_locals[nodes[i].xform] = locals[i]; }
+            if (nodes[i].visibility >= 0) { block_visibilities[nodes[i].visibility] = (int8_t)ctx->getNode(i)->getVisibility(); }
+        }
+
+        for (size_t mi = 0; mi < meshes.size(); ++mi) {
+            aiPolyMesh &mesh = *polymeshes[mi];
+            aiBakedMeshFrame &mf = mesh_frames[mi];
+            std::vector<aiSplitedMeshInfo> &splits = mesh_splits[mi];
+            int dirty = fi == 0 ? ~0 : mesh.getDirtyFlags();
+            if (!mesh.isTopologyConstant()) { meshes[mi].topology_constant = 0; }
+
+            bool split_changed = (dirty & aiMeshProperty_Topology) != 0;
+            if (split_changed) {
+                aiGetSplits(mesh, settings.max_vertices, new_splits);
+            }
+            else if (settings.share_vertices && (dirty & (aiMeshProperty_Normals | aiMeshProperty_UVs))) {
+                // shared vertices are welded by normal and uv indices too. the splits must match the vertices copied below
+                aiGetSplits(mesh, settings.max_vertices, new_splits);
+                split_changed = new_splits.size() != splits.size() ||
+                    memcmp(new_splits.data(), splits.data(), sizeof(aiSplitedMeshInfo) * splits.size()) != 0;
+            }
+
+            if (split_changed) {
+                splits.swap(new_splits);
+                mf.num_splits = (uint32_t)splits.size();
+                mf.num_indices = 0;
+                mf.num_vertices = 0;
+                for (const auto &s : splits) {
+                    mf.num_indices += s.triangulated_index_count;
+                    mf.num_vertices += s.num_vertices;
+                }
+                indices.resize(mf.num_indices);
+                size_t index_offset = 0;
+                for (const auto &s : splits) {
+                    if (s.triangulated_index_count > 0) { mesh.copySplitedIndices(&indices[index_offset], s); }
+                    index_offset += s.triangulated_index_count;
+                }
+                mf.splits = aiAppendFrameData(block, offset, splits);
+                mf.indices = aiAppendFrameData(block, offset, indices);
+                // split vertices are made from the topology
+                dirty = ~0;
+            }
+
+            if (dirty & aiMeshProperty_Positions) {
+                aiGatherSplitData(v3, splits, mf.num_vertices, [&](abcV3 *dst, const aiSplitedMeshInfo &smi) { mesh.copySplitedVertices(dst, smi); });
+                mf.positions = aiAppendFrameData(block, offset, v3);
+            }
+            if (!mesh.hasNormals()) {
+                mf.normals = 0;
+            }
+            else if ((dirty & aiMeshProperty_Normals) || mf.normals == 0) {
+                aiGatherSplitData(v3, splits, mf.num_vertices, [&](abcV3 *dst, const aiSplitedMeshInfo &smi) { mesh.copySplitedNormals(dst, smi); });
+                mf.normals = aiAppendFrameData(block, offset, v3);
+                meshes[mi].attributes |= aiMeshProperty_Normals;
+            }
+            if (!mesh.hasUVs()) {
+                mf.uvs = 0;
+            }
+            else if ((dirty & aiMeshProperty_UVs) || mf.uvs == 0) {
+                aiGatherSplitData(v2, splits, mf.num_vertices, [&](abcV2 *dst, const aiSplitedMeshInfo &smi) { mesh.copySplitedUVs(dst, smi); });
+                mf.uvs = aiAppendFrameData(block, offset, v2);
+                meshes[mi].attributes |= aiMeshProperty_UVs;
+            }
+            if (!mesh.hasTangents()) {
+                mf.tangents = 0;
+            }
+            else if ((dirty & aiMeshProperty_Tangents) || mf.tangents == 0) {
+                aiGatherSplitData(v4, splits, mf.num_vertices, [&](abcV4 *dst, const aiSplitedMeshInfo &smi) { mesh.copySplitedTangents(dst, smi); });
+                mf.tangents = aiAppendFrameData(block, offset, v4);
+                meshes[mi].attributes |= aiMeshProperty_Tangents;
+            }
+        }
+        if (!mesh_frames.empty()) {
+            memcpy(&block[sizeof(abcM44) * header.num_xforms], mesh_frames.data(), sizeof(aiBakedMeshFrame) * mesh_frames.size());
+        }
+
+        aiBakedFrame &frame = frames[fi];
+        frame.time = time;
+        frame.offset = offset;
+        frame.size = block.size();
+        os.write(block.data(), block.size());
+        offset += block.size();
+    }
+
+    auto put = [&](uint64_t pos, const void *data, size_t size) {
+        if (size > 0) { memcpy(&tables[(size_t)pos], data, size); }
+    };
+    put(0, &header, sizeof(header));
+    put(header.nodes, nodes.data(), sizeof(aiBakedNode) * nodes.size());
+    put(header.meshes, meshes.data(), sizeof(aiBakedMesh) * meshes.size());
+    put(header.strings, strings.data(), strings.size());
+    put(header.frames, frames.data(), sizeof(aiBakedFrame) * frames.size());
+    os.seekp(0);
+    os.write(tables.data(), tables.size());
+    os.close();
+    return !os.fail();
+}
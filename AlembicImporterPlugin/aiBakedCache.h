@@ -0,0 +1,131 @@
+﻿#ifndef aiBakedCache_h
+#define aiBakedCache_h
+
+#include "aiMappedFile.h"
+
+class aiContext;
+const uint32_t aiBakedMagic = 0x454b4142; // "BAKE"
+const uint32_t aiBakedVersion = 2;
+
+
+// layout of a baked cache file. it holds what aiContext would compute at each frame: local matrices of the xforms,
+// visibility of the nodes, and triangulated, split and expanded meshes, ready to be copied to vertex buffers as is.
+// everything is little endian and every array starts on a 16 byte boundary, so that the file is used in place
+// from a memory mapping. offsets are from the beginning of the file.
+//
+//   aiBakedHeader
+//   aiBakedNode[num_nodes]         in aiObject::getID() order, so parents come first
+//   aiBakedMesh[num_meshes]
+//   char strings[]                 null terminated names
+//   aiBakedFrame[num_frames]       frame index
+//   frames, one after another:
+//     abcM44 locals[num_xforms]
+//     aiBakedMeshFrame meshes[num_meshes]
+//     int8_t visibilities[num_visibilities]   AbcGeom::ObjectVisibility of the nodes themselves
+//     data of the meshes that changed since the previous frame
+//
+// mesh data that didn't change since the previous frame isn't written again, its offset refers to the data of
+// an earlier frame. the same offset means the same data.
+struct aiBakedHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_nodes;
+    uint32_t num_xforms;
+    uint32_t num_meshes;
+    uint32_t num_visibilities;
+    uint32_t num_frames;
+    float start_time;
+    float frame_rate;
+    uint32_t pad;
+    uint64_t nodes;
+    uint64_t meshes;
+    uint64_t strings;
+    uint64_t frames;
+};
+
+struct aiBakedNode
+{
+    int32_t parent;         // -1: top object
+    int32_t xform;          // index in the locals of each frame. -1: no xform
+    int32_t mesh;           // index in the meshes. -1: no polymesh
+    int32_t visibility;     // index in the visibilities of each frame. -1: no visibility property
+    uint32_t name;          // offsets in the strings
+    uint32_t full_name;
+};
+
+struct aiBakedMesh
+{
+    int32_t node;
+    uint32_t attributes;    // aiMeshProperty_Normals, _UVs and _Tangents of the frames that have them
+    uint32_t topology_constant;
+    int32_t max_vertices;   // the splits were made with
+};
+
+struct aiBakedFrame
+{
+    float time;
+    uint32_t pad;
+    uint64_t offset;
+    uint64_t size;
+};
+
+// vertices of all splits back to back. without shared vertices, every face corner is a vertex
+struct aiBakedMeshFrame
+{
+    uint32_t num_splits;
+    uint32_t num_indices;   // triangulated indices of all splits
+    uint32_t num_vertices;
+    uint32_t pad;
+    uint64_t splits;        // aiSplitedMeshInfo[num_splits]
+    uint64_t indices;       // int[num_indices]. relative to the first vertex of each split
+    uint64_t positions;     // abcV3[num_vertices]
+    uint64_t normals;       // abcV3[num_vertices]. 0: none
+    uint64_t uvs;           // abcV2[num_vertices]. 0: none
+    uint64_t tangents;      // abcV4[num_vertices]. 0: none
+};
+
+
+// read-only memory mapping of a baked cache
+class aiBakedCache
+{
+public:
+    // checks the header only
+    static bool isBakedCache(const char *path);
+
+    aiBakedCache();
+    ~aiBakedCache();
+    // maps the file and validates every offset in it, so that the accessors below don't have to
+    bool open(const char *path);
+    void close();
+
+    const aiBakedHeader&    getHeader() const;
+    const aiBakedNode&      getNode(int i) const;
+    const aiBakedMesh&      getMesh(int i) const;
+    const char*             getString(uint32_t offset) const;
+    // nearest frame of time, clamped to the baked range
+    int                     getFrame(float time) const;
+    float                   getFrameTime(int frame) const;
+    const abcM44&           getLocal(int frame, int xform) const;
+    const aiBakedMeshFrame& getMeshFrame(int frame, int mesh) const;
+    int8_t                  getVisibility(int frame, int visibility) const;
+    // null if offset is 0
+    template<class T> const T* get(uint64_t offset) const { return offset ? (const T*)(m_data + offset) : nullptr; }
+
+private:
+    bool validate() const;
+    bool contains(uint64_t offset, uint64_t size) const;
+
+private:
+    aiMappedFile m_file;
+    const char *m_data;
+    uint64_t m_size;
+};
+typedef std::shared_ptr<aiBakedCache> aiBakedCachePtr;
+
+
+// evaluates the archive loaded in src at every frame of settings and writes them to path as a baked cache.
+// the archive is opened again for that, so that src is left as it is
+bool aiBakeContext(aiContext *src, const char *path, const aiBakeSettings &settings);
+
+#endif // aiBakedCache_h
@@ -3,6 +3,8 @@
 #include "aiObject.h"
 #include "aiGeometry.h"
 #include "aiContext.h"
+#include "aiBakedCache.h"
+#include "aiDeltaCache.h"
 #include <limits>
 
 
@@ -17,6 +19,18 @@ void aiContext::destroy(aiContext* ctx)
 }
 
 aiContext::aiContext()
+    : m_delta_writer_cancel(false)
+    , m_time(0.0f)
+    , m_num_read_streams(0)
+    , m_memory_mapping(false)
+    , m_sample_cache_capacity(0)
+    , m_concurrent_reads(false)
+    , m_delta_cache(false)
+    , m_delta_writing(false)
+    , m_track_preload(false)
+    , m_visibility_culling(false)
+    , m_visibility_resolved(false)
+    , m_lazy_hierarchy(false)
 {
 #ifdef aiDebug
     m_magic = aiMagicCtx;
@@ -28,15 +42,60 @@ aiContext::aiContext()
 
 aiContext::~aiContext()
 {
+    // the writer reads through the nodes
+    m_delta_writer_cancel = true;
+    if (m_delta_writer.joinable()) { m_delta_writer.join(); }
     waitTasks();
+    m_prefetcher.clear();
         
     for (auto n : m_nodes) { delete n; }
     m_nodes.clear();
 }
 
-void aiContext::gatherNodesRecursive(aiObject *n)
+void aiContext::addNode(aiObject *n)
 {
+    // all but the top node of a lazy hierarchy are made after load(), which preloads the nodes there are
+    bool after_load = m_lazy_hierarchy && !m_nodes.empty();
+    if (m_lazy_hierarchy) {
+        n->setLazyChildren();
+    }
+    n->setID((int)m_nodes.size());
     m_nodes.push_back(n);
+    if (n->hasPolyMesh()) {
+        m_meshes.push_back(&n->getPolyMesh());
+    }
+    if (after_load) {
+        // nothing is read here: the next updateSamples() reads the node in its tasks, as the others.
+        // until then it only follows a hidden parent
+        if (!n->getParent()->isVisible()) { n->hideSubtree(); }
+        if (m_track_preload) {
+            n->preloadTracksLater();
+            addUpdateNode(n);
+        }
+    }
+}
+
+void aiContext::makeAllNodes()
+{
+    // depth first and in the order children are made, so that a context nothing was enumerated from
+    // gets the ids of a non-lazy one
+    if (m_nodes.empty()) { return; }
+    std::vector<std::pair<aiObject*, uint32_t>> stack(1, std::make_pair(m_nodes[0], 0u));
+    while (!stack.empty()) {
+        auto &top = stack.back();
+        if (top.second < top.first->getNumChildren()) {
+            aiObject *child = top.first->getChild(top.second++);
+            stack.push_back(std::make_pair(child, 0u));
+        }
+        else {
+            stack.pop_back();
+        }
+    }
+}
+
+void aiContext::gatherNodesRecursive(aiObject *n)
+{
+    addNode(n);
     abcObject &abc = n->getAbcObject();
     size_t num_children = abc.getNumChildren();
     for (size_t i = 0; i < num_children; ++i) {
@@ -47,13 +106,130 @@ void aiContext::gatherNodesRecursive(aiObject *n)
     }
 }
 
+void aiContext::setNumReadStreams(int n)
+{
+    m_num_read_streams = std::max<int>(n, 0);
+}
+
+void aiContext::enableMemoryMapping(bool v)
+{
+    m_memory_mapping = v;
+}
+
+void aiContext::setSampleCacheCapacity(uint64_t bytes)
+{
+    m_sample_cache_capacity = bytes;
+}
+
+void aiContext::setPrefetchCapacity(uint64_t bytes)
+{
+    m_prefetcher.setCapacity(bytes);
+}
+
+void aiContext::enableDeltaCache(bool v)
+{
+    m_delta_cache = v;
+}
+
+void aiContext::setDeltaCacheDirectory(const char *dir)
+{
+    m_delta_dir = dir ? dir : "";
+}
+
+void aiContext::enableDeltaCacheWriting(const aiDeltaCacheSettings *settings)
+{
+    m_delta_writing = settings != nullptr;
+    if (settings) { m_delta_settings = *settings; }
+}
+
+std::string aiContext::getDeltaCachePath() const
+{
+    return aiDeltaCache::getPath(m_path.c_str(), m_delta_dir);
+}
+
+void aiContext::enableTrackPreload(bool v)
+{
+    m_track_preload = v;
+}
+
+void aiContext::enableVisibilityCulling(bool v)
+{
+    m_visibility_culling = v;
+}
+
+void aiContext::enableLazyHierarchy(bool v)
+{
+    m_lazy_hierarchy = v;
+}
+
+aiTrackTimesPtr aiContext::getTrackTimes(const AbcCoreAbstract::TimeSamplingPtr &ts, size_t num_samples)
+{
+    std::unique_lock<std::mutex> lock(m_track_times_mutex);
+    aiTrackTimesPtr &times = m_track_times[std::make_pair(ts.get(), num_samples)];
+    if (!times) {
+        times.reset(new aiTrackTimes(*ts, num_samples));
+    }
+    return times;
+}
+
+// nodes are independent, so they are preloaded concurrently, each through the read stream of its thread
+void aiContext::preloadTracks()
+{
+    auto preload = [this](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            try {
+                m_nodes[i]->preloadTracks();
+            }
+            catch (Alembic::Util::Exception e)
+            {
+                // the node keeps reading its samples
+                aiDebugLog("exception: %s\n", e.what());
+            }
+        }
+    };
+    if (m_concurrent_reads) {
+        aiParallelFor(0, m_nodes.size(), 1, preload);
+    }
+    else {
+        preload(0, m_nodes.size());
+    }
+
+    for (auto n : m_nodes) {
+        addUpdateNode(n);
+    }
+}
+
+void aiContext::addUpdateNode(aiObject *n)
+{
+    bool reads = n->hasPolyMesh() || n->hasCurves() || n->hasPoints();
+    (reads ? m_read_nodes : m_track_nodes).push_back(n);
+}
+
 bool aiContext::load(const char *path)
 {
     if (path == nullptr) return false;
+    m_path = path;
+
+    if (aiBakedCache::isBakedCache(path)) {
+        return loadBaked(path);
+    }
 
     try {
-        aiDebugLog("trying to open AbcCoreOgawa::ReadArchive...\n");
-        m_archive = abcArchivePtr(new Abc::IArchive(AbcCoreOgawa::ReadArchive(), path));
+        // one Ogawa stream per thread that may read samples concurrently
+        size_t num_streams = m_num_read_streams > 0 ? m_num_read_streams : aiGetNumTaskThreads();
+        aiDebugLog("trying to open AbcCoreOgawa::ReadArchive (%d streams%s)...\n", (int)num_streams, m_memory_mapping ? ", mmap" : "");
+        AbcCoreAbstract::ReadArraySampleCachePtr cache;
+#ifdef aiWithPatchedOgawa
+        if (m_sample_cache_capacity > 0) {
+            cache = AbcCoreOgawa::CreateCache(m_sample_cache_capacity);
+        }
+        AbcCoreOgawa::ReadArchive reader(num_streams, m_memory_mapping);
+#else
+        // stock Ogawa can't map the file, and ignores caches
+        AbcCoreOgawa::ReadArchive reader(num_streams);
+#endif // aiWithPatchedOgawa
+        m_archive = abcArchivePtr(new Abc::IArchive(reader, path, Abc::ErrorHandler::kThrowPolicy, cache));
+        m_concurrent_reads = true;
     }
     catch (Alembic::Util::Exception e)
     {
@@ -70,9 +246,40 @@ bool aiContext::load(const char *path)
     }
 
     if (m_archive && m_archive->valid()) {
+        std::string delta_path = getDeltaCachePath();
+        if (m_delta_cache) {
+            // before the nodes, which look their meshes up in it
+            aiDeltaCachePtr deltas(new aiDeltaCache());
+            if (deltas->open(delta_path.c_str(), path, *m_archive)) { m_deltas = deltas; }
+        }
+
         abcObject abcTop = m_archive->getTop();
         aiObject *top = new aiObject(this, abcTop);
-        gatherNodesRecursive(top);
+        if (m_lazy_hierarchy) {
+            addNode(top);
+        }
+        else {
+            gatherNodesRecursive(top);
+        }
+        if (m_track_preload) {
+            preloadTracks();
+        }
+
+        if (m_delta_cache && m_delta_writing && !m_deltas && m_concurrent_reads) {
+            // for the next load. on a thread of its own, so that playback doesn't wait for a pass over the whole archive,
+            // which only Ogawa archives can be read by at the same time as by the updates
+            aiDeltaCacheSettings settings = m_delta_settings;
+            m_delta_writer = std::thread([this, delta_path, settings]() {
+                try {
+                    aiWriteDeltaCache(this, delta_path.c_str(), settings, &m_delta_writer_cancel);
+                }
+                catch (Alembic::Util::Exception e)
+                {
+                    aiDebugLog("exception: %s\n", e.what());
+                    std::remove(delta_path.c_str());
+                }
+            });
+        }
 
         m_time_range[0] = std::numeric_limits<double>::max();
         m_time_range[1] = -std::numeric_limits<double>::max();
@@ -118,6 +325,36 @@ bool aiContext::load(const char *path)
     }
 }
 
+bool aiContext::loadBaked(const char *path)
+{
+    aiDebugLog("trying to open baked cache...\n");
+    aiBakedCachePtr cache(new aiBakedCache());
+    if (!cache->open(path)) {
+        m_time_range[0] = 0.0;
+        m_time_range[1] = 0.0;
+        return false;
+    }
+    m_baked = cache;
+
+    // nodes are stored parents first, in the order gatherNodesRecursive() numbered them
+    const aiBakedHeader &header = cache->getHeader();
+    for (uint32_t i = 0; i < header.num_nodes; ++i) {
+        aiObject *n = new aiObject(this, *cache, (int)i);
+        n->setID((int)i);
+        int parent = cache->getNode(i).parent;
+        if (parent >= 0) {
+            m_nodes[parent]->addChild(n);
+        }
+        m_nodes.push_back(n);
+    }
+
+    m_time_range[0] = cache->getFrameTime(0);
+    m_time_range[1] = cache->getFrameTime(header.num_frames - 1);
+
+    aiDebugLog("succeeded\n");
+    return true;
+}
+
 float aiContext::getStartTime() const
 {
     return float(m_time_range[0]);
@@ -133,6 +370,210 @@ aiObject* aiContext::getTopObject()
     return m_nodes.empty() ? nullptr : m_nodes.front();
 }
 
+int aiContext::getNumNodes() const
+{
+    return (int)m_nodes.size();
+}
+
+aiObject* aiContext::getNode(int id)
+{
+    return id >= 0 && id < (int)m_nodes.size() ? m_nodes[id] : nullptr;
+}
+
+const aiBakedCache* aiContext::getBakedCache() const
+{
+    return m_baked.get();
+}
+
+const aiDeltaCache* aiContext::getDeltaCache() const
+{
+    return m_deltas.get();
+}
+
+const std::string& aiContext::getPath() const
+{
+    return m_path;
+}
+
+void aiContext::updateSamples(float time)
+{
+    // previous update may still be running
+    waitTasks();
+    m_time = time;
+
+    if (m_baked) {
+        // nothing to read or decode: nodes only look up their data of the frame in the mapping. meshes write their
+        // output buffers in their updates, which is left to tasks
+        for (auto n : m_nodes) {
+            n->updateVisibility(time);
+            if (m_visibility_culling && !n->isVisible()) { continue; }
+            if (n->hasPolyMesh()) { runTask([n, time]() { n->updateSamples(time); }); }
+            else { n->updateSamples(time); }
+        }
+        m_visibility_resolved = true;
+        return;
+    }
+
+    // culling evaluates all of it: nodes under hidden ones are hidden, whatever their own visibility says
+    m_visibility_resolved = m_visibility_culling;
+    if (m_visibility_culling) {
+        // the prefetch that follows goes by the visibility so far, as the tasks are evaluating the new one
+        m_visible_meshes.clear();
+        for (auto m : m_meshes) {
+            if (m->getObject()->isVisible()) { m_visible_meshes.push_back(m); }
+        }
+        if (!m_nodes.empty()) {
+            aiObject *top = m_nodes.front();
+            runTask([this, top, time]() { updateSubtree(top, time); });
+        }
+        return;
+    }
+
+    auto update = [time](aiObject *n) {
+        try {
+            n->updateSamples(time);
+        }
+        catch (Alembic::Util::Exception e)
+        {
+            aiDebugLog("exception: %s\n", e.what());
+        }
+    };
+
+    if (!m_concurrent_reads) {
+        // one task for all of them, which keeps the update off the calling thread still
+        runTask([this, update]() {
+            for (auto n : m_nodes) { update(n); }
+        });
+        return;
+    }
+
+    if (m_track_preload) {
+        // track lookups are far too short for a task per node
+        const size_t batch = 256;
+        for (size_t b = 0; b < m_track_nodes.size(); b += batch) {
+            size_t e = std::min(b + batch, m_track_nodes.size());
+            runTask([this, update, b, e]() {
+                for (size_t i = b; i < e; ++i) { update(m_track_nodes[i]); }
+            });
+        }
+        for (auto n : m_read_nodes) {
+            runTask([n, update]() { update(n); });
+        }
+        return;
+    }
+
+    for (auto n : m_nodes) {
+        runTask([n, update]() { update(n); });
+    }
+}
+
+// visibility culling: each node evaluates its visibility in its update task, and starts those of its children
+// only if it is visible, so that parents are always done first and nothing under a hidden node is read at all.
+// with track preload, nodes that only look up tracks are done in the task of their parent, as are all nodes of
+// HDF5 archives
+void aiContext::updateSubtree(aiObject *n, float time)
+{
+    try {
+        n->updateVisibility(time);
+        if (!n->isVisible()) {
+            n->hideSubtree();
+            return;
+        }
+        n->updateSamples(time);
+    }
+    catch (Alembic::Util::Exception e)
+    {
+        aiDebugLog("exception: %s\n", e.what());
+    }
+
+    uint32_t num_children = n->getNumChildren();
+    for (uint32_t i = 0; i < num_children; ++i) {
+        aiObject *c = n->findChild(i);
+        if (c == nullptr) { continue; }
+        bool reads = c->hasPolyMesh() || c->hasCurves() || c->hasPoints();
+        if (!m_concurrent_reads || (m_track_preload && !reads)) {
+            updateSubtree(c, time);
+        }
+        else {
+            runTask([this, c, time]() { updateSubtree(c, time); });
+        }
+    }
+}
+
+void aiContext::waitUpdate()
+{
+    waitTasks();
+}
+
+void aiContext::prefetchSamples(const float *times, int num_times)
+{
+    // the update may still be reading, and HDF5 archives can't be read concurrently
+    if (!m_concurrent_reads) { return; }
+    // meshes that show up later are read when they do
+    m_prefetcher.prefetch(m_visibility_culling ? m_visible_meshes : m_meshes, m_time, times, num_times);
+}
+
+aiPolyMeshSamplePtr aiContext::findPrefetchedSample(const aiPolyMesh *mesh, Abc::index_t index)
+{
+    return m_prefetcher.find(mesh, index);
+}
+
+int aiContext::getTransforms(abcM44 *world, abcM44 *local, int num_nodes)
+{
+    waitUpdate();
+
+    const abcM44 identity;
+    int n = std::min<int>(num_nodes, (int)m_nodes.size());
+    m_world_matrices.resize(n);
+    for (int i = 0; i < n; ++i) {
+        aiObject *node = m_nodes[i];
+        aiObject *parent = node->getParent();
+        const abcM44 &parent_world = parent ? m_world_matrices[parent->getID()] : identity;
+
+        abcM44 l;
+        bool inherits = true;
+        if (node->hasXForm()) {
+            l = node->getXForm().getMatrix();
+            inherits = node->getXForm().getInherits();
+        }
+
+        // row vectors: child local first, then parent
+        abcM44 &w = m_world_matrices[i];
+        w = inherits ? l * parent_world : l;
+        if (world) { world[i] = w; }
+        if (local) { local[i] = inherits ? l : w * parent_world.inverse(); }
+    }
+    return n;
+}
+
+void aiContext::resolveVisibility()
+{
+    waitUpdate();
+    if (m_visibility_resolved) { return; }
+
+    // parents first, as ids go
+    for (auto n : m_nodes) {
+        try {
+            n->updateVisibility(m_time);
+        }
+        catch (Alembic::Util::Exception e)
+        {
+            aiDebugLog("exception: %s\n", e.what());
+        }
+    }
+    m_visibility_resolved = true;
+}
+
+int aiContext::getVisibilities(bool *visible, int num_nodes)
+{
+    resolveVisibility();
+    int n = std::min<int>(num_nodes, (int)m_nodes.size());
+    for (int i = 0; i < n; ++i) {
+        visible[i] = m_nodes[i]->isVisible();
+    }
+    return n;
+}
+
 void aiContext::runTask(const std::function<void()> &task)
 {
     m_tasks.run(task);
@@ -1,11 +1,16 @@
 #ifndef aiContext_h
 #define aiContext_h
 
+#include <atomic>
 #include "aiThreadPool.h"
+#include "aiPrefetcher.h"
+#include "aiTracks.h"
 
 typedef std::shared_ptr<Abc::IArchive> abcArchivePtr;
 
 class aiObject;
+class aiBakedCache;
+class aiDeltaCache;
 const int aiMagicCtx = 0x00585443; // "CTX"
 
 
@@ -18,25 +23,119 @@ public:
 public:
     aiContext();
     ~aiContext();
+    // must be called before load(). 0: one stream per task thread
+    void setNumReadStreams(int n);
+    // must be called before load(). read Ogawa archives from a memory mapping of the file. ignored unless built
+    // with the patched Ogawa (aiWithPatchedOgawa)
+    void enableMemoryMapping(bool v);
+    // must be called before load(). share array samples with the same digest (identical data) across
+    // properties and frames, keeping at most 'bytes' of them alive. 0: no cache (Ogawa archives only, and only
+    // built with the patched Ogawa)
+    void setSampleCacheCapacity(uint64_t bytes);
+    // upper limit of mesh samples read ahead by prefetchSamples(). 0: no prefetch
+    void setPrefetchCapacity(uint64_t bytes);
+    // must be called before load(). decode positions from the delta cache of the archive, if it has a valid one
+    void enableDeltaCache(bool v);
+    // must be called before load(). the existing directory delta caches are looked up in and written to, named after
+    // the archive. empty: next to the archive
+    void setDeltaCacheDirectory(const char *dir);
+    // must be called before load(). with the delta cache enabled, load() writes it with these settings on a thread of
+    // its own if it is missing or out of date, for the next load. Ogawa archives only. null: never (default)
+    void enableDeltaCacheWriting(const aiDeltaCacheSettings *settings);
+    // where the delta cache of the loaded archive is looked up
+    std::string getDeltaCachePath() const;
+    // must be called before load(). read the xform, camera and visibility samples of the whole time range at load,
+    // so that updates only look them up
+    void enableTrackPreload(bool v);
+    // hidden nodes, and all nodes under them, are not updated by updateSamples() nor prefetched
+    void enableVisibilityCulling(bool v);
+    // must be called before load(). load() only makes the top node, the others are made when they are first
+    // enumerated, and read by the next updateSamples(). getNumNodes() and getNode() see the nodes made so far
+    void enableLazyHierarchy(bool v);
+    // opens an Alembic archive, or a baked cache written by aiBakeContext()
     bool load(const char *path);
+    const std::string& getPath() const;
     aiObject* getTopObject();
+    int getNumNodes() const;
+    aiObject* getNode(int id); // by aiObject::getID()
+    // gives the next id to a node just made, whose parent is added already. no update task may be running
+    void addNode(aiObject *n);
+    // makes all nodes a lazy hierarchy hasn't made yet
+    void makeAllNodes();
+    // null unless the loaded file is a baked cache
+    const aiBakedCache* getBakedCache() const;
+    // null unless enabled and the archive has a valid one
+    const aiDeltaCache* getDeltaCache() const;
     float getStartTime() const;
     float getEndTime() const;
 
+    // kick off sample reads of all nodes on the thread pool. waitUpdate() blocks until they are done.
+    // HDF5 archives are read by one task at a time.
+    void updateSamples(float time);
+    void waitUpdate();
+    // read mesh samples at the given upcoming times on the thread pool (in that order), so that later
+    // updateSamples() with these times don't have to wait for them. must be called after updateSamples().
+    // does nothing on HDF5 archives, which the update may be reading.
+    void prefetchSamples(const float *times, int num_times);
+    aiPolyMeshSamplePtr findPrefetchedSample(const aiPolyMesh *mesh, Abc::index_t index);
+    // shared by the tracks of all properties with the same sampling and number of samples
+    aiTrackTimesPtr getTrackTimes(const AbcCoreAbstract::TimeSamplingPtr &ts, size_t num_samples);
+
+    // evaluates the transforms of all nodes, indexed by aiObject::getID(). world and local may be null.
+    // local is relative to the parent node even if the node doesn't inherit its parent's transform.
+    // nodes without xform get identity. returns the number of nodes written.
+    int getTransforms(abcM44 *world, abcM44 *local, int num_nodes);
+    // whether each node is visible at the time of the last updateSamples(), indexed by aiObject::getID().
+    // returns the number of nodes written.
+    int getVisibilities(bool *visible, int num_nodes);
+    // waits for the update, and evaluates the visibility of nodes if it didn't. updateSamples() only does that
+    // with visibility culling, so everything that reads the visibility of nodes must call this first
+    void resolveVisibility();
+
     void runTask(const std::function<void ()> &task);
     void waitTasks();
 
 private:
     void gatherNodesRecursive(aiObject *n);
+    void preloadTracks();
+    void addUpdateNode(aiObject *n);
+    void updateSubtree(aiObject *n, float time);
+    bool loadBaked(const char *path);
 
 private:
 #ifdef aiDebug
     int m_magic;
 #endif // aiDebug
     abcArchivePtr m_archive;
+    std::string m_path;
+    std::shared_ptr<aiBakedCache> m_baked;
+    std::shared_ptr<aiDeltaCache> m_deltas;
+    std::thread m_delta_writer;
+    std::atomic<bool> m_delta_writer_cancel;
     std::vector<aiObject*> m_nodes;
     aiTaskGroup m_tasks;
+    aiPrefetcher m_prefetcher;
+    std::vector<aiPolyMesh*> m_meshes;
+    std::vector<aiPolyMesh*> m_visible_meshes; // with visibility culling, at the start of the last updateSamples()
+    std::vector<abcM44> m_world_matrices;
+    std::map<std::pair<const AbcCoreAbstract::TimeSampling*, size_t>, aiTrackTimesPtr> m_track_times;
+    std::mutex m_track_times_mutex;
+    std::vector<aiObject*> m_track_nodes;   // with track preload, the nodes whose updates are only track lookups
+    std::vector<aiObject*> m_read_nodes;    // and the others
+    float m_time;
     double m_time_range[2];
+    int m_num_read_streams;
+    bool m_memory_mapping;
+    uint64_t m_sample_cache_capacity;
+    bool m_concurrent_reads;    // Ogawa archives only: HDF5 can't be read from several threads at once
+    bool m_delta_cache;
+    std::string m_delta_dir;
+    bool m_delta_writing;
+    aiDeltaCacheSettings m_delta_settings;
+    bool m_track_preload;
+    bool m_visibility_culling;
+    bool m_visibility_resolved; // of all nodes at m_time, once the update is done
+    bool m_lazy_hierarchy;
 };
 
 
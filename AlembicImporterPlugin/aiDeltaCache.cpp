@@ -0,0 +1,433 @@
+﻿#include "pch.h"
+#include "AlembicImporter.h"
+#include "aiObject.h"
+#include "aiContext.h"
+#include "aiDeltaCache.h"
+#include "aiSIMD.h"
+#include "aiThreadPool.h"
+#include <fstream>
+#include <cmath>
+#include <sys/stat.h>
+
+// below this many points decoding isn't worth splitting into tasks
+static const size_t aiMinPointsPerTask = 0x4000;
+
+
+static uint64_t aiAlign16(uint64_t v)
+{
+    return (v + 15) & ~uint64_t(15);
+}
+
+// 0s if the file can't be read
+static void aiGetFileStat(const char *path, uint64_t &o_size, uint64_t &o_mtime)
+{
+    struct stat st;
+    bool ok = stat(path, &st) == 0;
+    o_size = ok ? (uint64_t)st.st_size : 0;
+    o_mtime = ok ? (uint64_t)st.st_mtime : 0;
+}
+
+// false if the array sample has no key, which only the HDF5 back end may lack
+template<class PropertyType>
+static bool aiGetDigest(const PropertyType &prop, size_t index, uint64_t (&o_digest)[2])
+{
+    AbcCoreAbstract::ArraySampleKey key;
+    if (!prop.getKey(key, Abc::ISampleSelector((Abc::index_t)index))) { return false; }
+    o_digest[0] = key.digest.words[0];
+    o_digest[1] = key.digest.words[1];
+    return true;
+}
+
+// invalid if there is no object of that full name
+static abcObject aiFindObject(abcObject obj, const std::string &full_name)
+{
+    size_t begin = 0;
+    while (obj.valid() && begin < full_name.size()) {
+        size_t end = full_name.find('/', begin);
+        if (end == std::string::npos) { end = full_name.size(); }
+        if (end > begin) { obj = obj.getChild(full_name.substr(begin, end - begin)); }
+        begin = end + 1;
+    }
+    return obj;
+}
+
+static uint64_t aiGetDeltaDataSize(uint32_t format, uint64_t num_positions)
+{
+    switch (format) {
+    case aiDeltaFormat_Key:   return sizeof(abcV3) * num_positions;
+    case aiDeltaFormat_Int16: return sizeof(int16_t) * 3 * num_positions;
+    case aiDeltaFormat_Int8:  return sizeof(int8_t) * 3 * num_positions;
+    }
+    return 0;
+}
+
+
+std::string aiDeltaCache::getPath(const char *archive_path, const std::string &dir)
+{
+    std::string path(archive_path);
+    if (!dir.empty()) {
+        size_t slash = path.find_last_of("/\\");
+        path = dir + "/" + (slash == std::string::npos ? path : path.substr(slash + 1));
+    }
+    return path + ".delta";
+}
+
+aiDeltaCache::aiDeltaCache()
+    : m_data(nullptr)
+    , m_size(0)
+{
+}
+
+bool aiDeltaCache::open(const char *path, const char *archive_path, Abc::IArchive &archive)
+{
+    close();
+    if (!m_file.open(path)) { return false; }
+    m_data = m_file.getData();
+    m_size = m_file.getSize();
+
+    if (!validate() || !matches(archive_path, archive)) {
+        aiDebugLog("aiDeltaCache::open(): %s is not a valid delta cache of %s\n", path, archive_path);
+        close();
+        return false;
+    }
+    for (uint32_t i = 0; i < getHeader().num_meshes; ++i) {
+        m_meshes[m_data + getHeader().strings + getMesh(i).full_name] = (int)i;
+    }
+    return true;
+}
+
+void aiDeltaCache::close()
+{
+    m_file.close();
+    m_data = nullptr;
+    m_size = 0;
+    m_meshes.clear();
+}
+
+bool aiDeltaCache::contains(uint64_t offset, uint64_t size) const
+{
+    return offset <= m_size && size <= m_size - offset;
+}
+
+bool aiDeltaCache::validate() const
+{
+    if (!contains(0, sizeof(aiDeltaHeader))) { return false; }
+    const aiDeltaHeader &h = getHeader();
+    if (h.magic != aiDeltaMagic || h.version != aiDeltaVersion || h.keyframe_interval == 0) { return false; }
+    if (!contains(h.meshes, sizeof(aiDeltaMesh) * h.num_meshes) || h.strings > h.samples || h.samples > m_size) {
+        return false;
+    }
+
+    const char *strings = m_data + h.strings;
+    size_t strings_size = size_t(h.samples - h.strings);
+    for (uint32_t mi = 0; mi < h.num_meshes; ++mi) {
+        const aiDeltaMesh &m = getMesh(mi);
+        if (m.full_name >= strings_size || memchr(strings + m.full_name, '\0', strings_size - m.full_name) == nullptr ||
+            !contains(h.samples + sizeof(aiDeltaSample) * m.first_sample, sizeof(aiDeltaSample) * m.num_samples))
+        {
+            return false;
+        }
+        for (uint32_t si = 0; si < m.num_samples; ++si) {
+            const aiDeltaSample &s = getSample(mi, si);
+            if (s.format > aiDeltaFormat_Int8 || s.key < 0 || s.key > (int32_t)si ||
+                getSample(mi, s.key).format != aiDeltaFormat_Key ||
+                s.data == 0 || !contains(s.data, aiGetDeltaDataSize(s.format, m.num_positions)))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// the archive may have been rewritten since the cache was made, even with the same size and within the resolution
+// of the modification time, so the first and last positions of every mesh are compared too
+bool aiDeltaCache::matches(const char *archive_path, Abc::IArchive &archive) const
+{
+    const aiDeltaHeader &h = getHeader();
+    uint64_t size, mtime;
+    aiGetFileStat(archive_path, size, mtime);
+    if (size == 0 || h.archive_size != size || h.archive_mtime != mtime) { return false; }
+
+    abcObject top = archive.getTop();
+    for (uint32_t mi = 0; mi < h.num_meshes; ++mi) {
+        const aiDeltaMesh &m = getMesh(mi);
+        abcObject obj = aiFindObject(top, m_data + h.strings + m.full_name);
+        if (!obj.valid() || !AbcGeom::IPolyMeshSchema::matches(obj.getMetaData())) { return false; }
+
+        Abc::IP3fArrayProperty prop = AbcGeom::IPolyMesh(obj, Abc::kWrapExisting).getSchema().getPositionsProperty();
+        uint64_t first[2], last[2];
+        if (prop.getNumSamples() != m.num_samples ||
+            !aiGetDigest(prop, 0, first) || !aiGetDigest(prop, m.num_samples - 1, last) ||
+            memcmp(first, m.first_digest, sizeof(first)) != 0 || memcmp(last, m.last_digest, sizeof(last)) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const aiDeltaHeader& aiDeltaCache::getHeader() const
+{
+    return *(const aiDeltaHeader*)m_data;
+}
+
+const aiDeltaMesh& aiDeltaCache::getMesh(int i) const
+{
+    return ((const aiDeltaMesh*)(m_data + getHeader().meshes))[i];
+}
+
+const aiDeltaSample& aiDeltaCache::getSample(int mesh, int sample) const
+{
+    return ((const aiDeltaSample*)(m_data + getHeader().samples))[getMesh(mesh).first_sample + sample];
+}
+
+int aiDeltaCache::findMesh(const std::string &full_name, size_t num_samples) const
+{
+    auto i = m_meshes.find(full_name);
+    if (i == m_meshes.end() || getMesh(i->second).num_samples != num_samples) { return -1; }
+    return i->second;
+}
+
+size_t aiDeltaCache::getNumPositions(int mesh) const
+{
+    return getMesh(mesh).num_positions;
+}
+
+// decoded positions and the array sample that refers to them, so that the sample owns them
+struct aiDecodedPositions
+{
+    std::vector<abcV3> data;
+    Abc::P3fArraySample sample;
+
+    aiDecodedPositions(size_t num) : data(num), sample(data.data(), num) {}
+};
+
+template<class T>
+static void aiParallelDecodeDeltaPoints(abcV3 *dst, const abcV3 *key, const T *deltas, size_t num, const abcV3 &step)
+{
+    aiParallelFor(0, num, aiMinPointsPerTask, [&](size_t b, size_t e) {
+        aiDecodeDeltaPoints(dst + b, key + b, deltas + b * 3, e - b, step);
+    });
+}
+
+Abc::P3fArraySamplePtr aiDeltaCache::decode(int mesh, int sample) const
+{
+    size_t num = getMesh(mesh).num_positions;
+    const aiDeltaSample &s = getSample(mesh, sample);
+    const abcV3 *key = (const abcV3*)(m_data + getSample(mesh, s.key).data);
+    abcV3 step(s.step[0], s.step[1], s.step[2]);
+
+    std::shared_ptr<aiDecodedPositions> ret(new aiDecodedPositions(num));
+    abcV3 *dst = ret->data.data();
+    switch (s.format) {
+    case aiDeltaFormat_Key:
+        aiParallelFor(0, num, aiMinPointsPerTask, [&](size_t b, size_t e) {
+            std::copy(key + b, key + e, dst + b);
+        });
+        break;
+    case aiDeltaFormat_Int16:
+        aiParallelDecodeDeltaPoints(dst, key, (const int16_t*)(m_data + s.data), num, step);
+        break;
+    case aiDeltaFormat_Int8:
+        aiParallelDecodeDeltaPoints(dst, key, (const int8_t*)(m_data + s.data), num, step);
+        break;
+    }
+    // aliasing constructor: the sample shares ownership of the decoded data
+    return Abc::P3fArraySamplePtr(ret, &ret->sample);
+}
+
+
+
+// writes data to os at a 16 byte boundary. returns its offset in the file
+static uint64_t aiAppendData(std::ofstream &os, uint64_t &offset, const void *data, size_t size)
+{
+    static const char zeros[16] = {};
+    uint64_t ret = offset;
+    os.write((const char*)data, size);
+    os.write(zeros, (size_t)(aiAlign16(size) - size));
+    offset += aiAlign16(size);
+    return ret;
+}
+
+// quantizes d = positions - key to steps of max |d| / limit, per axis
+template<class T>
+static void aiQuantizeDeltas(std::vector<T> &dst, const std::vector<abcV3> &deltas, const abcV3 &step, int limit)
+{
+    abcV3 inv(
+        step.x > 0.0f ? 1.0f / step.x : 0.0f,
+        step.y > 0.0f ? 1.0f / step.y : 0.0f,
+        step.z > 0.0f ? 1.0f / step.z : 0.0f);
+    auto quantize = [&](float v) {
+        int q = (int)std::floor(v + 0.5f);
+        return (T)std::min<int>(std::max<int>(q, -limit), limit);
+    };
+    dst.resize(deltas.size() * 3);
+    for (size_t i = 0; i < deltas.size(); ++i) {
+        dst[i * 3 + 0] = quantize(deltas[i].x * inv.x);
+        dst[i * 3 + 1] = quantize(deltas[i].y * inv.y);
+        dst[i * 3 + 2] = quantize(deltas[i].z * inv.z);
+    }
+}
+
+// quantizes as aiQuantizeDeltas() and decodes the result back as aiDeltaCache::decode() does. false unless that gives
+// positions exactly back
+template<class T>
+static bool aiQuantizeDeltasLossless(std::vector<T> &dst, std::vector<abcV3> &decoded, const std::vector<abcV3> &deltas,
+    const abcV3 *positions, const abcV3 *key, const abcV3 &step, int limit)
+{
+    aiQuantizeDeltas(dst, deltas, step, limit);
+    decoded.resize(deltas.size());
+    aiDecodeDeltaPoints(decoded.data(), key, dst.data(), deltas.size(), step);
+    return memcmp(decoded.data(), positions, sizeof(abcV3) * deltas.size()) == 0;
+}
+
+bool aiWriteDeltaCache(aiContext *ctx, const char *path, const aiDeltaCacheSettings &settings, const std::atomic<bool> *cancel)
+{
+    aiObject *top = ctx->getTopObject();
+    if (path == nullptr || top == nullptr || ctx->getBakedCache() != nullptr || settings.keyframe_interval <= 0) {
+        return false;
+    }
+
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    if (!os) { return false; }
+    auto fail = [&]() {
+        os.close();
+        std::remove(path);
+        return false;
+    };
+
+    aiDeltaHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = aiDeltaMagic;
+    header.version = aiDeltaVersion;
+    header.keyframe_interval = (uint32_t)settings.keyframe_interval;
+    aiGetFileStat(ctx->getPath().c_str(), header.archive_size, header.archive_mtime);
+
+    // zeros until the header is complete, so that a partial file is never valid
+    uint64_t offset = 0;
+    aiDeltaHeader blank;
+    memset(&blank, 0, sizeof(blank));
+    aiAppendData(os, offset, &blank, sizeof(blank));
+
+    std::vector<aiDeltaMesh> meshes;
+    std::vector<aiDeltaSample> samples;
+    std::string strings;
+    std::vector<abcV3> deltas;
+    std::vector<abcV3> decoded;
+    std::vector<int16_t> d16;
+    std::vector<int8_t> d8;
+
+    // the archive is walked rather than the nodes, which a lazy hierarchy makes on other threads meanwhile.
+    // depth first, children in order, which is the order of the node ids of a complete hierarchy
+    std::vector<abcObject> stack(1, top->getAbcObject());
+    while (!stack.empty()) {
+        abcObject obj = stack.back();
+        stack.pop_back();
+        for (size_t ci = obj.getNumChildren(); ci > 0; --ci) {
+            stack.push_back(obj.getChild(ci - 1));
+        }
+        if (!AbcGeom::IPolyMeshSchema::matches(obj.getMetaData())) { continue; }
+        if (cancel && cancel->load()) { return fail(); }
+
+        AbcGeom::IPolyMeshSchema schema = AbcGeom::IPolyMesh(obj, Abc::kWrapExisting).getSchema();
+        Abc::IP3fArrayProperty prop = schema.getPositionsProperty();
+        size_t num_samples = prop.getNumSamples();
+        if (schema.getTopologyVariance() != AbcGeom::kHomogenousTopology || num_samples < 2) { continue; }
+
+        aiDeltaMesh dm;
+        memset(&dm, 0, sizeof(dm));
+        dm.num_samples = (uint32_t)num_samples;
+        dm.first_sample = (uint32_t)samples.size();
+        if (!aiGetDigest(prop, 0, dm.first_digest) || !aiGetDigest(prop, num_samples - 1, dm.last_digest)) { continue; }
+        Abc::P3fArraySamplePtr key;
+        size_t key_index = 0;
+        bool valid = true;
+        for (size_t si = 0; si < num_samples && valid; ++si) {
+            if (cancel && cancel->load()) { return fail(); }
+
+            Abc::P3fArraySamplePtr positions;
+            prop.get(positions, Abc::ISampleSelector((Abc::index_t)si));
+            size_t num = positions ? positions->size() : 0;
+            if (si == 0) { dm.num_positions = (uint32_t)num; }
+            if (num == 0 || num != dm.num_positions) {
+                valid = false;
+                break;
+            }
+
+            aiDeltaSample ds;
+            memset(&ds, 0, sizeof(ds));
+            bool make_key = si == 0 || si - key_index >= (size_t)settings.keyframe_interval;
+            if (!make_key) {
+                const abcV3 *p = positions->get();
+                const abcV3 *k = key->get();
+                abcV3 range(0.0f);
+                bool finite = true;
+                deltas.resize(num);
+                for (size_t i = 0; i < num; ++i) {
+                    deltas[i] = p[i] - k[i];
+                    finite = finite && std::isfinite(deltas[i].x) && std::isfinite(deltas[i].y) && std::isfinite(deltas[i].z);
+                    range.x = std::max<float>(range.x, std::abs(deltas[i].x));
+                    range.y = std::max<float>(range.y, std::abs(deltas[i].y));
+                    range.z = std::max<float>(range.z, std::abs(deltas[i].z));
+                }
+                abcV3 step16 = range / 32767.0f;
+                abcV3 step8 = range / 127.0f;
+                float error16 = std::max<float>(step16.x, std::max<float>(step16.y, step16.z)) * 0.5f;
+                float error8 = std::max<float>(step8.x, std::max<float>(step8.y, step8.z)) * 0.5f;
+                bool lossless = settings.max_error <= 0.0f;
+                if (!finite) {
+                    // can't be quantized
+                    make_key = true;
+                }
+                else if (lossless ? aiQuantizeDeltasLossless(d8, decoded, deltas, p, k, step8, 127) : error8 <= settings.max_error) {
+                    if (!lossless) { aiQuantizeDeltas(d8, deltas, step8, 127); }
+                    ds.format = aiDeltaFormat_Int8;
+                    memcpy(ds.step, &step8.x, sizeof(ds.step));
+                    ds.data = aiAppendData(os, offset, d8.data(), d8.size());
+                }
+                else if (lossless ? aiQuantizeDeltasLossless(d16, decoded, deltas, p, k, step16, 32767) : error16 <= settings.max_error) {
+                    if (!lossless) { aiQuantizeDeltas(d16, deltas, step16, 32767); }
+                    ds.format = aiDeltaFormat_Int16;
+                    memcpy(ds.step, &step16.x, sizeof(ds.step));
+                    ds.data = aiAppendData(os, offset, d16.data(), sizeof(int16_t) * d16.size());
+                }
+                else {
+                    make_key = true;
+                }
+                ds.key = (int32_t)key_index;
+            }
+            if (make_key) {
+                key = positions;
+                key_index = si;
+                ds.key = (int32_t)si;
+                ds.format = aiDeltaFormat_Key;
+                ds.data = aiAppendData(os, offset, positions->get(), sizeof(abcV3) * num);
+            }
+            samples.push_back(ds);
+        }
+
+        if (!valid) {
+            // what was written of it stays as unreferenced data
+            samples.resize(dm.first_sample);
+            continue;
+        }
+        dm.full_name = (uint32_t)strings.size();
+        strings.append(obj.getFullName()).push_back('\0');
+        meshes.push_back(dm);
+    }
+
+    header.num_meshes = (uint32_t)meshes.size();
+    header.meshes = aiAppendData(os, offset, meshes.data(), sizeof(aiDeltaMesh) * meshes.size());
+    header.strings = aiAppendData(os, offset, strings.data(), strings.size());
+    header.samples = aiAppendData(os, offset, samples.data(), sizeof(aiDeltaSample) * samples.size());
+    os.seekp(0);
+    os.write((const char*)&header, sizeof(header));
+    os.close();
+    if (!os) {
+        std::remove(path);
+        return false;
+    }
+    aiDebugLog("aiWriteDeltaCache(): %s %d meshes\n", path, (int)meshes.size());
+    return true;
+}
@@ -0,0 +1,106 @@
+﻿#ifndef aiDeltaCache_h
+#define aiDeltaCache_h
+
+#include <atomic>
+#include "aiMappedFile.h"
+
+class aiContext;
+const uint32_t aiDeltaMagic = 0x41544c44; // "DLTA"
+const uint32_t aiDeltaVersion = 2;
+
+
+// layout of a delta cache, the sidecar file of an archive with the positions of its constant topology meshes
+// (homogeneous topology: every sample has the same number of positions).
+// a sample is either a keyframe, the positions as they are, or the positions quantized as deltas against the
+// keyframe before it. keyframes come at least every keyframe_interval samples, so that any sample is decoded from
+// two reads: its keyframe and its deltas. deltas are rounded to a per sample and per axis step, which is the
+// largest delta of the axis / 32767 (or / 127 for 8 bit deltas), so the error is at most half a step. lossless caches
+// only have deltas that decode back to exactly the positions of the archive.
+// everything is little endian and every array starts on a 16 byte boundary. offsets are from the beginning of the file.
+//
+//   aiDeltaHeader
+//   data of the samples
+//   aiDeltaMesh[num_meshes]
+//   char strings[]                 null terminated full names of the meshes
+//   aiDeltaSample[]                the samples of each mesh, back to back
+struct aiDeltaHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_meshes;
+    uint32_t keyframe_interval;
+    uint64_t archive_size;  // of the archive the cache was made from. the cache is ignored if these don't match
+    uint64_t archive_mtime;
+    uint64_t meshes;
+    uint64_t strings;
+    uint64_t samples;
+};
+
+struct aiDeltaMesh
+{
+    uint32_t full_name;     // offset in the strings
+    uint32_t num_samples;
+    uint32_t num_positions;
+    uint32_t first_sample;  // index of its first aiDeltaSample
+    uint64_t first_digest[2]; // of the positions of its first and last samples in the archive, which must match too
+    uint64_t last_digest[2];
+};
+
+enum aiDeltaFormat
+{
+    aiDeltaFormat_Key,      // abcV3[num_positions]
+    aiDeltaFormat_Int16,    // int16_t[num_positions * 3]
+    aiDeltaFormat_Int8,     // int8_t[num_positions * 3]
+};
+
+struct aiDeltaSample
+{
+    int32_t key;            // sample index of the keyframe. itself for keyframes
+    uint32_t format;        // aiDeltaFormat
+    float step[3];
+    uint32_t pad;
+    uint64_t data;
+};
+
+// read-only memory mapping of a delta cache
+class aiDeltaCache
+{
+public:
+    // the sidecar of the archive at archive_path, in dir if it isn't empty
+    static std::string getPath(const char *archive_path, const std::string &dir);
+
+    aiDeltaCache();
+    // maps the file and validates every offset in it. fails if the cache wasn't made from archive, opened from
+    // archive_path
+    bool open(const char *path, const char *archive_path, Abc::IArchive &archive);
+    void close();
+
+    // -1 if the cache has no mesh of that name with num_samples samples
+    int findMesh(const std::string &full_name, size_t num_samples) const;
+    size_t getNumPositions(int mesh) const;
+    // decodes positions of the sample. can be called from any thread
+    Abc::P3fArraySamplePtr decode(int mesh, int sample) const;
+
+private:
+    bool validate() const;
+    bool matches(const char *archive_path, Abc::IArchive &archive) const;
+    bool contains(uint64_t offset, uint64_t size) const;
+    const aiDeltaHeader& getHeader() const;
+    const aiDeltaMesh& getMesh(int i) const;
+    const aiDeltaSample& getSample(int mesh, int sample) const;
+
+private:
+    aiMappedFile m_file;
+    const char *m_data;
+    uint64_t m_size;
+    std::map<std::string, int> m_meshes; // by full name
+};
+typedef std::shared_ptr<aiDeltaCache> aiDeltaCachePtr;
+
+
+// encodes the positions of the constant topology meshes of the archive loaded in ctx and writes them to path.
+// reads the archive only, so it can run while ctx plays an Ogawa archive. stops, removes the file and returns false
+// as soon as cancel is set
+bool aiWriteDeltaCache(aiContext *ctx, const char *path, const aiDeltaCacheSettings &settings, const std::atomic<bool> *cancel = nullptr);
+
+#endif // aiDeltaCache_h
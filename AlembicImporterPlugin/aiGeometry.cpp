@@ -2,6 +2,69 @@
 #include "AlembicImporter.h"
 #include "aiGeometry.h"
 #include "aiObject.h"
+#include "aiContext.h"
+#include "aiSIMD.h"
+#include "aiThreadPool.h"
+#include "aiGraphicsDevice.h"
+#include "aiBakedCache.h"
+#include "aiDeltaCache.h"
+
+// below this many elements a copy isn't worth splitting into tasks
+static const size_t aiMinElementsPerTask = 0x4000;
+
+// the aiSIMD.h kernels, split over the thread pool
+
+template<class T>
+static void aiParallelCopy(T *dst, const T *src, size_t num)
+{
+    aiParallelFor(0, num, aiMinElementsPerTask, [&](size_t b, size_t e) {
+        std::copy(src + b, src + e, dst + b);
+    });
+}
+
+static void aiParallelCopyPoints(abcV3 *dst, const abcV3 *src, size_t num, bool reverse_x)
+{
+    aiParallelFor(0, num, aiMinElementsPerTask, [&](size_t b, size_t e) {
+        aiCopyPoints(dst + b, src + b, e - b, reverse_x);
+    });
+}
+
+static void aiParallelGatherPoints(abcV3 *dst, const abcV3 *src, const int *indices, size_t num, bool reverse_x)
+{
+    aiParallelFor(0, num, aiMinElementsPerTask, [&](size_t b, size_t e) {
+        aiGatherPoints(dst + b, src, indices + b, e - b, reverse_x);
+    });
+}
+
+static void aiParallelGatherPoints(abcV2 *dst, const abcV2 *src, const int *indices, size_t num)
+{
+    aiParallelFor(0, num, aiMinElementsPerTask, [&](size_t b, size_t e) {
+        aiGatherPoints(dst + b, src, indices + b, e - b);
+    });
+}
+
+static void aiParallelCopyIndices(int *dst, const int *src, size_t num, bool reverse)
+{
+    aiParallelFor(0, num, aiMinElementsPerTask, [&](size_t b, size_t e) {
+        // reversed, dst[b, e) comes from src[num - e, num - b)
+        aiCopyIndices(dst + b, src + (reverse ? num - e : b), e - b, reverse);
+    });
+}
+
+
+template<class T>
+static size_t aiGetSizeInBytes(const std::shared_ptr<T> &samp)
+{
+    return samp ? samp->size() * sizeof(typename T::value_type) : 0;
+}
+
+size_t aiPolyMeshSample::getSizeInBytes() const
+{
+    return aiGetSizeInBytes(indices) + aiGetSizeInBytes(counts) + aiGetSizeInBytes(positions) + aiGetSizeInBytes(velocities) +
+        aiGetSizeInBytes(normals.getVals()) + aiGetSizeInBytes(normals.getIndices()) +
+        aiGetSizeInBytes(uvs.getVals()) + aiGetSizeInBytes(uvs.getIndices());
+}
+
 
 
 aiSchema::aiSchema() : m_obj(nullptr) {}
@@ -9,21 +72,211 @@ aiSchema::aiSchema(aiObject *obj) : m_obj(obj) {}
 aiSchema::~aiSchema() {}
 
 
+// returns true if ss selects other data than what state refers to, and updates state.
+// samples are compared by index first, then by the digest stored in the archive.
+template<class PropertyType>
+static bool aiSampleChanged(const PropertyType &prop, const Abc::ISampleSelector &ss, aiSampleState &state)
+{
+    Abc::index_t index = ss.getIndex(prop.getTimeSampling(), prop.getNumSamples());
+    if (index == state.index) {
+        return false;
+    }
+    state.index = index;
+
+    AbcCoreAbstract::ArraySampleKey key;
+    if (prop.getKey(key, Abc::ISampleSelector(index))) {
+        if (state.has_key && key == state.key) {
+            return false;
+        }
+        state.key = key;
+        state.has_key = true;
+    }
+    else {
+        state.has_key = false;
+    }
+    return true;
+}
+
+// o_indices_changed, if not null, tells whether the indices alone changed
+template<class GeomParamType>
+static bool aiGeomParamSampleChanged(GeomParamType param, const Abc::ISampleSelector &ss, aiSampleState &vals_state, aiSampleState &indices_state,
+    bool *o_indices_changed = nullptr)
+{
+    bool changed = aiSampleChanged(param.getValueProperty(), ss, vals_state);
+    bool indices_changed = param.isIndexed() && aiSampleChanged(param.getIndexProperty(), ss, indices_state);
+    if (o_indices_changed) { *o_indices_changed = indices_changed; }
+    return changed || indices_changed;
+}
+
+// true if a and b refer to the same data. by digest if both have one
+static bool aiSameSample(const aiSampleState &a, const aiSampleState &b)
+{
+    if (a.has_key && b.has_key) { return a.key == b.key; }
+    return a.has_key == b.has_key && a.index == b.index;
+}
+
+
 
-aiXForm::aiXForm() {}
+aiXForm::aiXForm()
+    : m_sample_index(-1), m_next_index(-1), m_blend(0.0f), m_inherits(false), m_next_inherits(false), m_dirty(false)
+    , m_baked(nullptr), m_baked_index(-1)
+{}
 
 aiXForm::aiXForm(aiObject *obj)
-    : super(obj)
+    : super(obj), m_sample_index(-1), m_next_index(-1), m_blend(0.0f), m_inherits(false), m_next_inherits(false), m_dirty(false)
+    , m_baked(nullptr), m_baked_index(-1)
 {
     AbcGeom::IXform xf(obj->getAbcObject(), Abc::kWrapExisting);
     m_schema = xf.getSchema();
 }
 
+aiXForm::aiXForm(aiObject *obj, const aiBakedCache *cache, int xform)
+    : super(obj), m_sample_index(-1), m_next_index(-1), m_blend(0.0f), m_inherits(true), m_next_inherits(true), m_dirty(false)
+    , m_baked(cache), m_baked_index(xform)
+{
+}
+
+void aiXForm::preloadTrack()
+{
+    size_t num_samples = m_schema.getNumSamples();
+    if (m_baked || num_samples == 0) { return; }
+
+    aiTrack<TrackSample> track;
+    track.times = m_obj->getContext()->getTrackTimes(m_schema.getTimeSampling(), num_samples);
+    track.samples.resize(num_samples);
+    // the inherits flag hardly ever changes, and reading it costs about half as much as the sample
+    bool constant_inherits = true;
+    if (m_schema.getPropertyHeader(".inherits")) {
+        constant_inherits = Abc::IBoolProperty(m_schema, ".inherits").isConstant();
+    }
+    bool inherits = m_schema.getInheritsXforms(Abc::ISampleSelector((Abc::index_t)0));
+    AbcGeom::XformSample sample;
+    for (size_t i = 0; i < num_samples; ++i) {
+        Abc::ISampleSelector iss((Abc::index_t)i);
+        m_schema.get(sample, iss);
+        track.samples[i].matrix = abcM44(sample.getMatrix());
+        track.samples[i].inherits = constant_inherits ? inherits : m_schema.getInheritsXforms(iss);
+    }
+    m_track = std::move(track);
+}
+
+void aiXForm::readSample(Abc::index_t index, Abc::M44d &o_matrix, bool &o_inherits)
+{
+    if (m_track.valid()) {
+        const TrackSample &sample = m_track.samples[index];
+        o_matrix = Abc::M44d(sample.matrix);
+        o_inherits = sample.inherits;
+    }
+    else {
+        Abc::ISampleSelector iss(index);
+        AbcGeom::XformSample sample;
+        m_schema.get(sample, iss);
+        o_matrix = sample.getMatrix();
+        o_inherits = m_schema.getInheritsXforms(iss);
+    }
+}
+
+// scale, shear and translation are blended linearly, rotation spherically
+static Abc::M44d aiLerpMatrix(const Abc::M44d &a, const Abc::M44d &b, double t)
+{
+    const Abc::M44d *src[2] = { &a, &b };
+    Abc::V3d scale[2], shear[2], translation[2];
+    Imath::Quatd rotation[2];
+    for (int i = 0; i < 2; ++i) {
+        Abc::M44d m = *src[i];
+        translation[i] = m.translation();
+        if (!Imath::extractAndRemoveScalingAndShear(m, scale[i], shear[i], false)) {
+            // degenerate. no meaningful rotation to blend
+            return t < 0.5 ? a : b;
+        }
+        rotation[i] = Imath::extractQuat(m);
+    }
+
+    Abc::M44d s, h, r, tr;
+    s.setScale(scale[0] + (scale[1] - scale[0]) * t);
+    h.setShear(shear[0] + (shear[1] - shear[0]) * t);
+    r = Imath::slerpShortestArc(rotation[0], rotation[1], t).toMatrix44();
+    tr.setTranslation(translation[0] + (translation[1] - translation[0]) * t);
+    return s * h * r * tr;
+}
+
 void aiXForm::updateSample()
 {
-    Abc::ISampleSelector ss(m_obj->getCurrentTime());
-    m_schema.get(m_sample, ss);
-    m_inherits = m_schema.getInheritsXforms(ss);
+    if (m_baked) {
+        updateBakedSample();
+        return;
+    }
+
+    float time = m_obj->getCurrentTime();
+    size_t num_samples = m_track.valid() ? m_track.times->getNumSamples() : m_schema.getNumSamples();
+    bool interpolate = m_obj->getSubframeMode() == aiSubframeMode_Linear && num_samples > 1;
+
+    Abc::index_t index, next;
+    double t0 = 0.0, t1 = 0.0;
+    if (m_track.valid()) {
+        const aiTrackTimes &times = *m_track.times;
+        index = interpolate ? times.getFloorIndex(time) : times.getNearIndex(time);
+        next = interpolate ? times.getCeilIndex(time) : index;
+        if (next != index) {
+            t0 = times.getTime(index);
+            t1 = times.getTime(next);
+        }
+    }
+    else {
+        auto ts = m_schema.getTimeSampling();
+        Abc::ISampleSelector ss(time, interpolate ? Abc::ISampleSelector::kFloorIndex : Abc::ISampleSelector::kNearIndex);
+        index = ss.getIndex(ts, num_samples);
+        next = interpolate ? Abc::ISampleSelector(time, Abc::ISampleSelector::kCeilIndex).getIndex(ts, num_samples) : index;
+        if (next != index) {
+            t0 = ts->getSampleTime(index);
+            t1 = ts->getSampleTime(next);
+        }
+    }
+    float blend = next != index ? (float)std::max<double>(0.0, std::min<double>((time - t0) / (t1 - t0), 1.0)) : 0.0f;
+
+    m_dirty = index != m_sample_index || (blend != 0.0f && next != m_next_index) || blend != m_blend;
+    if (!m_dirty) {
+        return;
+    }
+
+    if (index != m_sample_index) {
+        // playing forward, the sample after the last one is already here
+        if (index == m_next_index) {
+            m_floor_matrix = m_next_matrix;
+            m_inherits = m_next_inherits;
+        }
+        else {
+            readSample(index, m_floor_matrix, m_inherits);
+        }
+        m_sample_index = index;
+    }
+    if (blend != 0.0f && next != m_next_index) {
+        readSample(next, m_next_matrix, m_next_inherits);
+        m_next_index = next;
+    }
+    m_blend = blend;
+
+    m_matrix = blend == 0.0f ? m_floor_matrix : aiLerpMatrix(m_floor_matrix, m_next_matrix, blend);
+}
+
+void aiXForm::updateBakedSample()
+{
+    int frame = m_baked->getFrame(m_obj->getCurrentTime());
+    m_dirty = frame != m_sample_index;
+    if (!m_dirty) {
+        return;
+    }
+
+    // baked locals are relative to the parent even where the node doesn't inherit
+    m_matrix = Abc::M44d(m_baked->getLocal(frame, m_baked_index));
+    m_inherits = true;
+    m_sample_index = frame;
+}
+
+
+bool aiXForm::isDirty() const
+{
+    return m_dirty;
 }
 
 
@@ -34,7 +287,7 @@ bool aiXForm::getInherits() const
 
 abcV3 aiXForm::getPosition() const
 {
-    abcV3 ret = m_sample.getTranslation();
+    abcV3 ret = m_matrix.translation();
     if (m_obj->getReverseX()) {
         ret.x *= -1.0f;
     }
@@ -43,7 +296,7 @@ abcV3 aiXForm::getPosition() const
 
 abcV3 aiXForm::getAxis() const
 {
-    abcV3 ret = m_sample.getAxis();
+    abcV3 ret = Imath::extractQuat(m_matrix).axis();
     if (m_obj->getReverseX()) {
         ret.x *= -1.0f;
     }
@@ -52,7 +305,7 @@ abcV3 aiXForm::getAxis() const
 
 float aiXForm::getAngle() const
 {
-    float ret = m_sample.getAngle();
+    float ret = AbcGeom::RadiansToDegrees(Imath::extractQuat(m_matrix).angle());
     if (m_obj->getReverseX()) {
         ret *= -1.0f;
     }
@@ -61,317 +314,2036 @@ float aiXForm::getAngle() const
 
 abcV3 aiXForm::getScale() const
 {
-    return abcV3(m_sample.getScale());
+    Abc::V3d ret;
+    Imath::extractScaling(m_matrix, ret);
+    return abcV3(ret);
 }
 
 abcM44 aiXForm::getMatrix() const
 {
-    return abcM44(m_sample.getMatrix());
+    abcM44 ret(m_matrix);
+    if (m_obj->getReverseX()) {
+        // mirror on the YZ plane: S * M * S with S = scale(-1, 1, 1)
+        ret[0][1] *= -1.0f; ret[0][2] *= -1.0f; ret[0][3] *= -1.0f;
+        ret[1][0] *= -1.0f; ret[2][0] *= -1.0f; ret[3][0] *= -1.0f;
+    }
+    return ret;
 }
 
 
 
-aiPolyMesh::aiPolyMesh() {}
+aiPolyMesh::aiPolyMesh()
+    : m_dirty_flags(0), m_next_index(-1), m_subframe_param(0.0f)
+    , m_use_subframe_positions(false), m_use_subframe_normals(false), m_generated_normals_dirty(true), m_tangents_dirty(true)
+    , m_output_result(), m_output_max_vertices(0), m_output_options(0), m_output_pending(false)
+    , m_position_bounds_dirty(true), m_uv_bounds_dirty(true), m_bounds_reverse_x(false)
+    , m_baked(nullptr), m_baked_index(-1), m_baked_frame(nullptr), m_deltas(nullptr), m_delta_index(-1)
+{
+    std::fill_n(m_output_formats, (int)aiMeshOutputSlot_Count, (int)aiVertexFormat_Float);
+}
 
 aiPolyMesh::aiPolyMesh(aiObject *obj)
-    : super(obj)
+    : super(obj), m_dirty_flags(0), m_next_index(-1), m_subframe_param(0.0f)
+    , m_use_subframe_positions(false), m_use_subframe_normals(false), m_generated_normals_dirty(true), m_tangents_dirty(true)
+    , m_output_result(), m_output_max_vertices(0), m_output_options(0), m_output_pending(false)
+    , m_position_bounds_dirty(true), m_uv_bounds_dirty(true), m_bounds_reverse_x(false)
+    , m_baked(nullptr), m_baked_index(-1), m_baked_frame(nullptr), m_deltas(nullptr), m_delta_index(-1)
 {
+    std::fill_n(m_output_formats, (int)aiMeshOutputSlot_Count, (int)aiVertexFormat_Float);
     AbcGeom::IPolyMesh pm(obj->getAbcObject(), Abc::kWrapExisting);
     m_schema = pm.getSchema();
+
+    if (const aiDeltaCache *deltas = obj->getContext()->getDeltaCache()) {
+        m_delta_index = deltas->findMesh(obj->getFullName(), m_schema.getPositionsProperty().getNumSamples());
+        if (m_delta_index >= 0) { m_deltas = deltas; }
+    }
+}
+
+aiPolyMesh::aiPolyMesh(aiObject *obj, const aiBakedCache *cache, int mesh)
+    : super(obj), m_dirty_flags(0), m_next_index(-1), m_subframe_param(0.0f)
+    , m_use_subframe_positions(false), m_use_subframe_normals(false), m_generated_normals_dirty(true), m_tangents_dirty(true)
+    , m_output_result(), m_output_max_vertices(0), m_output_options(0), m_output_pending(false)
+    , m_position_bounds_dirty(true), m_uv_bounds_dirty(true), m_bounds_reverse_x(false)
+    , m_baked(cache), m_baked_index(mesh), m_baked_frame(nullptr), m_deltas(nullptr), m_delta_index(-1)
+{
+    std::fill_n(m_output_formats, (int)aiMeshOutputSlot_Count, (int)aiVertexFormat_Float);
 }
 
 void aiPolyMesh::updateSample()
 {
-    Abc::ISampleSelector ss(m_obj->getCurrentTime());
-    m_schema.getFaceIndicesProperty().get(m_indices, ss);
-    m_schema.getFaceCountsProperty().get(m_counts, ss);
-    m_schema.getPositionsProperty().get(m_positions, ss);
+    if (m_baked) {
+        updateBakedSample();
+        writeOutputBuffersAhead();
+        return;
+    }
+
+    float time = m_obj->getCurrentTime();
+    Abc::ISampleSelector ss(time, getTimeIndexType());
+    m_dirty_flags = 0;
+
+    // use the data read ahead by the prefetcher if it is ready. change detection still goes through the archive
+    aiPolyMeshSamplePtr pre = m_obj->getContext()->findPrefetchedSample(this, getSampleIndex(time));
+
+    if (aiSampleChanged(m_schema.getFaceIndicesProperty(), ss, m_indices_state)) {
+        if (pre) { m_indices = pre->indices; }
+        else { m_schema.getFaceIndicesProperty().get(m_indices, ss); }
+        m_dirty_flags |= aiMeshProperty_Indices;
+    }
+    if (aiSampleChanged(m_schema.getFaceCountsProperty(), ss, m_counts_state)) {
+        if (pre) { m_counts = pre->counts; }
+        else { m_schema.getFaceCountsProperty().get(m_counts, ss); }
+        m_dirty_flags |= aiMeshProperty_Counts;
+    }
+    if (aiSampleChanged(m_schema.getPositionsProperty(), ss, m_positions_state)) {
+        if (pre) { m_positions = pre->positions; }
+        else if (m_next_positions && m_positions_state.index == m_next_index) { m_positions = m_next_positions; }
+        else { m_positions = readPositions(m_positions_state.index); }
+        m_dirty_flags |= aiMeshProperty_Positions;
+    }
 
-    m_velocities.reset();
     if (m_schema.getVelocitiesProperty().valid()) {
-        m_schema.getVelocitiesProperty().get(m_velocities, ss);
+        if (aiSampleChanged(m_schema.getVelocitiesProperty(), ss, m_velocities_state)) {
+            if (pre) { m_velocities = pre->velocities; }
+            else { m_schema.getVelocitiesProperty().get(m_velocities, ss); }
+            m_dirty_flags |= aiMeshProperty_Velocities;
+        }
     }
 
-    m_normals.reset();
+    bool normal_indices_changed = false, uv_indices_changed = false;
     if (m_schema.getNormalsParam().valid()) {
-        m_schema.getNormalsParam().getIndexed(m_normals, ss);
+        if (aiGeomParamSampleChanged(m_schema.getNormalsParam(), ss, m_normals_state, m_normal_indices_state, &normal_indices_changed)) {
+            if (pre) { m_normals = pre->normals; }
+            else if (m_next_normals.valid() && m_normals_state.index == m_next_index) { m_normals = m_next_normals; }
+            else { m_schema.getNormalsParam().getIndexed(m_normals, ss); }
+            m_dirty_flags |= aiMeshProperty_Normals;
+        }
     }
 
-    m_uvs.reset();
     if (m_schema.getUVsParam().valid()) {
-        m_schema.getUVsParam().getIndexed(m_uvs, ss);
+        if (aiGeomParamSampleChanged(m_schema.getUVsParam(), ss, m_uvs_state, m_uv_indices_state, &uv_indices_changed)) {
+            if (pre) { m_uvs = pre->uvs; }
+            else { m_schema.getUVsParam().getIndexed(m_uvs, ss); }
+            m_dirty_flags |= aiMeshProperty_UVs;
+        }
+    }
+    // shared vertices are welded by normal and uv indices too, so new ones make new split indices
+    if ((normal_indices_changed || uv_indices_changed) && m_obj->getShareVertices()) {
+        m_dirty_flags |= aiMeshProperty_Indices;
+    }
+
+    updateSubframeData(time);
+
+    if (m_dirty_flags & aiMeshProperty_Positions) { m_position_bounds_dirty = true; }
+    if (m_dirty_flags & aiMeshProperty_UVs) { m_uv_bounds_dirty = true; }
+    if (m_dirty_flags & (aiMeshProperty_Topology | aiMeshProperty_Positions)) {
+        m_generated_normals_dirty = true;
+        if (hasGeneratedNormals()) {
+            m_dirty_flags |= aiMeshProperty_Normals;
+        }
     }
+    if (m_dirty_flags & (aiMeshProperty_Topology | aiMeshProperty_Positions | aiMeshProperty_Normals | aiMeshProperty_UVs)) {
+        m_tangents_dirty = true;
+        if (hasTangents()) {
+            m_dirty_flags |= aiMeshProperty_Tangents;
+        }
+    }
+
+    if (m_texture && m_dirty_flags != 0) {
+        aiTextureMeshBuffers &tex = *m_texture;
+        int back;
+        {
+            std::unique_lock<std::mutex> lock(tex.mutex);
+            tex.back_ready = false;
+            back = tex.front ^ 1;
+        }
+        packTextureData(tex.buffers[back]);
+        {
+            std::unique_lock<std::mutex> lock(tex.mutex);
+            tex.back_ready = true;
+        }
+    }
+    writeOutputBuffersAhead();
 }
 
-bool aiPolyMesh::isTopologyConstant() const
+// data the mesh refers to is only ever replaced by data at another offset, so comparing offsets is enough
+void aiPolyMesh::updateBakedSample()
 {
-    return m_schema.isConstant();
+    int frame = m_baked->getFrame(m_obj->getCurrentTime());
+    const aiBakedMeshFrame *prev = m_baked_frame;
+    const aiBakedMeshFrame &cur = m_baked->getMeshFrame(frame, m_baked_index);
+    m_baked_frame = &cur;
+
+    m_dirty_flags = 0;
+    if (!prev || prev->splits != cur.splits || prev->indices != cur.indices) {
+        m_dirty_flags |= aiMeshProperty_Topology;
+
+        const aiSplitedMeshInfo *splits = m_baked->get<aiSplitedMeshInfo>(cur.splits);
+        m_baked_index_offsets.resize(cur.num_splits);
+        m_baked_vertex_offsets.resize(cur.num_splits);
+        int index_offset = 0, vertex_offset = 0;
+        for (uint32_t si = 0; si < cur.num_splits; ++si) {
+            m_baked_index_offsets[si] = index_offset;
+            m_baked_vertex_offsets[si] = vertex_offset;
+            index_offset += splits[si].triangulated_index_count;
+            vertex_offset += splits[si].num_vertices;
+        }
+    }
+    if (!prev || prev->positions != cur.positions) { m_dirty_flags |= aiMeshProperty_Positions; }
+    if (!prev || prev->normals != cur.normals) { m_dirty_flags |= aiMeshProperty_Normals; }
+    if (!prev || prev->uvs != cur.uvs) { m_dirty_flags |= aiMeshProperty_UVs; }
+    if (!prev || prev->tangents != cur.tangents) { m_dirty_flags |= aiMeshProperty_Tangents; }
+
+    if (m_dirty_flags & (aiMeshProperty_Topology | aiMeshProperty_Positions)) { m_position_bounds_dirty = true; }
+    if (m_dirty_flags & (aiMeshProperty_Topology | aiMeshProperty_UVs)) { m_uv_bounds_dirty = true; }
 }
 
-bool aiPolyMesh::isTopologyConstantTriangles() const
+size_t aiPolyMesh::getNumSamples() const
 {
-    return m_schema.isConstant() && (*m_counts)[0] == 3;
+    if (m_baked) { return m_baked->getHeader().num_frames; }
+    return m_schema.getNumSamples();
 }
 
-bool aiPolyMesh::hasNormals() const
+Abc::index_t aiPolyMesh::getSampleIndex(float time) const
 {
-    return m_normals.valid();
+    if (m_baked) { return m_baked->getFrame(time); }
+    return Abc::ISampleSelector(time, getTimeIndexType()).getIndex(m_schema.getTimeSampling(), m_schema.getNumSamples());
 }
 
-bool aiPolyMesh::hasUVs() const
+bool aiPolyMesh::useVelocities() const
 {
-    return m_uvs.valid();
+    return m_obj->getSubframeMode() == aiSubframeMode_Velocity && m_schema.getVelocitiesProperty().valid();
 }
 
-uint32_t aiPolyMesh::getIndexCount() const
+bool aiPolyMesh::useInterpolation() const
 {
-    if (m_obj->getTriangulate())
-    {
-        uint32_t r = 0;
-        const auto &counts = *m_counts;
-        size_t n = counts.size();
-        for (size_t fi = 0; fi < n; ++fi) {
-            int ngon = counts[fi];
-            r += (ngon - 2) * 3;
-        }
-        return r;
-    }
-    else
-    {
-        return m_indices->size();
-    }
+    return m_obj->getSubframeMode() == aiSubframeMode_Linear && m_schema.getTopologyVariance() != AbcGeom::kHeterogenousTopology;
 }
 
-uint32_t aiPolyMesh::getVertexCount() const
+// both subframe modes start from the sample preceding the time
+Abc::ISampleSelector::TimeIndexType aiPolyMesh::getTimeIndexType() const
 {
-    return m_positions->size();
+    return useVelocities() || useInterpolation() ? Abc::ISampleSelector::kFloorIndex : Abc::ISampleSelector::kNearIndex;
 }
 
-void aiPolyMesh::copyIndices(int *dst) const
+// aiSubframeMode_Velocity moves the positions of the preceding sample to time. held at the last sample, and
+// never moved past the next one.
+// aiSubframeMode_Linear blends positions and normals with those of the next sample, which stays resident so that
+// the following frames between the same two samples don't read anything.
+void aiPolyMesh::updateSubframeData(float time)
 {
-    bool reverse_index = m_obj->getReverseIndex();
-    const auto &counts = *m_counts;
-    const auto &indices = *m_indices;
-
-    if (m_obj->getTriangulate())
-    {
-        uint32_t a = 0;
-        uint32_t b = 0;
-        uint32_t i1 = reverse_index ? 2 : 1;
-        uint32_t i2 = reverse_index ? 1 : 2;
-        size_t n = counts.size();
-        for (size_t fi = 0; fi < n; ++fi) {
-            int ngon = counts[fi];
-            for (int ni = 0; ni < (ngon - 2); ++ni) {
-                dst[b + 0] = std::max<int>(indices[a], 0);
-                dst[b + 1] = std::max<int>(indices[a + i1 + ni], 0);
-                dst[b + 2] = std::max<int>(indices[a + i2 + ni], 0);
-                b += 3;
-            }
-            a += ngon;
+    size_t num_positions = m_positions ? m_positions->size() : 0;
+    auto positions_prop = m_schema.getPositionsProperty();
+    auto ts = positions_prop.getTimeSampling();
+    size_t num_samples = positions_prop.getNumSamples();
+    Abc::index_t index = m_positions_state.index;
+
+    float param = 0.0f;
+    bool inputs_changed = (m_dirty_flags & (aiMeshProperty_Positions | aiMeshProperty_Velocities | aiMeshProperty_Normals)) != 0;
+    bool lerp_normals = false;
+    if (num_positions > 0 && useVelocities()) {
+        if (m_velocities && m_velocities->size() == num_positions) {
+            double t0 = ts->getSampleTime(index);
+            double t1 = (size_t)index + 1 < num_samples ? ts->getSampleTime(index + 1) : t0;
+            param = (float)std::max<double>(0.0, std::min<double>(time - t0, t1 - t0));
         }
     }
-    else
-    {
-        size_t n = indices.size();
-        if (reverse_index) {
-            for (size_t i = 0; i < n; ++i) {
-                dst[i] = indices[n - i - 1];
+    else if (num_positions > 0 && useInterpolation()) {
+        Abc::index_t next = Abc::ISampleSelector(time, Abc::ISampleSelector::kCeilIndex).getIndex(ts, num_samples);
+        if (next != index) {
+            if (next != m_next_index) {
+                aiPolyMeshSamplePtr pre = m_obj->getContext()->findPrefetchedSample(this, next);
+                Abc::ISampleSelector nss(next);
+                if (pre) { m_next_positions = pre->positions; }
+                else { m_next_positions = readPositions(next); }
+                m_next_normal_indices_state = aiSampleState();
+                if (m_schema.getNormalsParam().valid()) {
+                    if (pre) { m_next_normals = pre->normals; }
+                    else { m_schema.getNormalsParam().getIndexed(m_next_normals, nss); }
+                    if (m_schema.getNormalsParam().isIndexed()) {
+                        aiSampleChanged(m_schema.getNormalsParam().getIndexProperty(), nss, m_next_normal_indices_state);
+                    }
+                }
+                m_next_index = next;
+                inputs_changed = true;
             }
+            if (m_next_positions->size() == num_positions) {
+                double t0 = ts->getSampleTime(index);
+                double t1 = ts->getSampleTime(next);
+                param = (float)std::max<double>(0.0, std::min<double>((time - t0) / (t1 - t0), 1.0));
+            }
+            // values are only blended if they are indexed the same way. otherwise the normals of the held sample are used
+            lerp_normals = m_normals.valid() && m_next_normals.valid() &&
+                m_normals.getVals()->size() == m_next_normals.getVals()->size() &&
+                m_normals.isIndexed() == m_next_normals.isIndexed() &&
+                aiSameSample(m_normal_indices_state, m_next_normal_indices_state);
         }
-        else {
-            for (size_t i = 0; i < n; ++i) {
-                dst[i] = indices[i];
+    }
+
+    if (param != 0.0f) {
+        // the blended normals are stale if they weren't in use
+        bool normals_stale = lerp_normals && !m_use_subframe_normals;
+        if (!m_use_subframe_positions || param != m_subframe_param || inputs_changed || normals_stale) {
+            m_subframe_positions.resize(num_positions);
+            abcV3 *dst = m_subframe_positions.data();
+            const abcV3 *positions = m_positions->get();
+            if (useVelocities()) {
+                const abcV3 *velocities = m_velocities->get();
+                aiParallelFor(0, num_positions, aiMinElementsPerTask, [&](size_t b, size_t e) {
+                    aiExtrapolatePoints(dst + b, positions + b, velocities + b, e - b, param);
+                });
+            }
+            else {
+                const abcV3 *next = m_next_positions->get();
+                aiParallelFor(0, num_positions, aiMinElementsPerTask, [&](size_t b, size_t e) {
+                    aiLerpPoints(dst + b, positions + b, next + b, e - b, param);
+                });
+            }
+            m_dirty_flags |= aiMeshProperty_Positions;
+
+            if (lerp_normals) {
+                size_t num_normals = m_normals.getVals()->size();
+                m_subframe_normals.resize(num_normals);
+                abcV3 *ndst = m_subframe_normals.data();
+                const abcV3 *n0 = m_normals.getVals()->get();
+                const abcV3 *n1 = m_next_normals.getVals()->get();
+                aiParallelFor(0, num_normals, aiMinElementsPerTask, [&](size_t b, size_t e) {
+                    aiLerpPoints(ndst + b, n0 + b, n1 + b, e - b, param);
+                    for (size_t i = b; i < e; ++i) { ndst[i].normalize(); }
+                });
+                m_dirty_flags |= aiMeshProperty_Normals;
             }
         }
     }
+    else if (m_use_subframe_positions) {
+        // back to the sample as is
+        m_dirty_flags |= aiMeshProperty_Positions;
+    }
+    bool use_subframe_normals = param != 0.0f && lerp_normals;
+    if (use_subframe_normals != m_use_subframe_normals) {
+        // getNormals() switches between the blended normals and those of the sample
+        m_dirty_flags |= aiMeshProperty_Normals;
+    }
+    m_use_subframe_positions = param != 0.0f;
+    m_use_subframe_normals = use_subframe_normals;
+    m_subframe_param = param;
 }
 
-void aiPolyMesh::copyVertices(abcV3 *dst) const
+const abcV3* aiPolyMesh::getPositions() const
 {
-    const auto &cont = *m_positions;
-    size_t n = cont.size();
-    for (size_t i = 0; i < n; ++i) {
-        dst[i] = cont[i];
-    }
-    if (m_obj->getReverseX()) {
-        for (size_t i = 0; i < n; ++i) {
-            dst[i].x *= -1.0f;
-        }
-    }
+    if (m_baked) { return m_baked_frame ? m_baked->get<abcV3>(m_baked_frame->positions) : nullptr; }
+    return m_use_subframe_positions ? m_subframe_positions.data() : m_positions->get();
 }
-void aiPolyMesh::copyNormals(abcV3 *dst) const
+
+const abcV3* aiPolyMesh::getNormalValues() const
 {
-    const auto &cont = *m_normals.getVals();
-    // todo
+    return m_use_subframe_normals ? m_subframe_normals.data() : m_normals.getVals()->get();
 }
 
-void aiPolyMesh::copyUVs(abcV2 *dst) const
+aiPolyMeshSamplePtr aiPolyMesh::readSample(Abc::index_t index) const
 {
-    const auto &cont = *m_uvs.getVals();
-    // todo
+    Abc::ISampleSelector ss(index);
+    aiPolyMeshSamplePtr ret(new aiPolyMeshSample());
+    ret->index = index;
+
+    m_schema.getFaceIndicesProperty().get(ret->indices, ss);
+    m_schema.getFaceCountsProperty().get(ret->counts, ss);
+    ret->positions = readPositions(index);
+    if (m_schema.getVelocitiesProperty().valid()) {
+        m_schema.getVelocitiesProperty().get(ret->velocities, ss);
+    }
+    if (m_schema.getNormalsParam().valid()) {
+        m_schema.getNormalsParam().getIndexed(ret->normals, ss);
+    }
+    if (m_schema.getUVsParam().valid()) {
+        m_schema.getUVsParam().getIndexed(ret->uvs, ss);
+    }
+    return ret;
 }
 
-bool aiPolyMesh::getSplitedMeshInfo(aiSplitedMeshInfo &o_smi, const aiSplitedMeshInfo& prev, int max_vertices) const
+Abc::P3fArraySamplePtr aiPolyMesh::readPositions(Abc::index_t index) const
 {
-    const auto &counts = *m_counts;
-    const auto &indices = *m_indices;
-    size_t nc = counts.size();
+    if (m_deltas) { return m_deltas->decode(m_delta_index, (int)index); }
+    Abc::P3fArraySamplePtr ret;
+    m_schema.getPositionsProperty().get(ret, Abc::ISampleSelector(index));
+    return ret;
+}
 
-    aiSplitedMeshInfo smi = { 0 };
-    smi.begin_face = prev.begin_face + prev.num_faces;
-    smi.begin_index = prev.begin_index + prev.num_indices;
+int aiPolyMesh::getDirtyFlags() const
+{
+    return m_dirty_flags;
+}
 
-    bool is_end = true;
-    int a = 0;
-    for (size_t i = smi.begin_face; i < nc; ++i) {
-        int ngon = counts[i];
-        if (a + ngon >= max_vertices) {
-            is_end = false;
-            break;
-        }
+bool aiPolyMesh::isTopologyConstant() const
+{
+    if (m_baked) { return m_baked->getMesh(m_baked_index).topology_constant != 0; }
+    return m_schema.isConstant();
+}
 
-        a += ngon;
-        smi.num_faces++;
-        smi.num_indices = a;
-        smi.triangulated_index_count += (ngon - 2) * 3;
-    }
+bool aiPolyMesh::isTopologyConstantTriangles() const
+{
+    // baked meshes are triangulated
+    if (m_baked) { return isTopologyConstant(); }
+    return m_schema.isConstant() && (*m_counts)[0] == 3;
+}
 
-    smi.num_vertices = a;
-    o_smi = smi;
-    return is_end;
+bool aiPolyMesh::hasNormals() const
+{
+    if (m_baked) { return m_baked_frame && m_baked_frame->normals != 0; }
+    return m_normals.valid() || hasGeneratedNormals();
 }
 
-void aiPolyMesh::copySplitedIndices(int *dst, const aiSplitedMeshInfo &smi) const
+bool aiPolyMesh::hasGeneratedNormals() const
 {
-    bool reverse_index = m_obj->getReverseIndex();
-    const auto &counts = *m_counts;
-    const auto &indices = *m_indices;
+    // baked normals are already generated
+    return !m_baked && !m_normals.valid() && m_obj->getGenerateNormals();
+}
 
-    uint32_t a = 0;
-    uint32_t b = 0;
-    uint32_t i1 = reverse_index ? 2 : 1;
-    uint32_t i2 = reverse_index ? 1 : 2;
-    for (int fi = 0; fi < smi.num_faces; ++fi) {
-        int ngon = counts[smi.begin_face + fi];
-        for (int ni = 0; ni < (ngon - 2); ++ni) {
-            dst[b + 0] = a;
-            dst[b + 1] = a + i1 + ni;
-            dst[b + 2] = a + i2 + ni;
-            b += 3;
-        }
-        a += ngon;
-    }
+bool aiPolyMesh::hasTangents() const
+{
+    if (m_baked) { return m_baked_frame && m_baked_frame->tangents != 0; }
+    return m_obj->getGenerateTangents() && m_uvs.valid() && hasNormals();
 }
 
-void aiPolyMesh::copySplitedVertices(abcV3 *dst, const aiSplitedMeshInfo &smi) const
+bool aiPolyMesh::hasUVs() const
 {
-    const auto &counts = *m_counts;
-    const auto &indices = *m_indices;
-    const auto &positions = *m_positions;
+    if (m_baked) { return m_baked_frame && m_baked_frame->uvs != 0; }
+    return m_uvs.valid();
+}
 
-    uint32_t a = 0;
-    for (int fi = 0; fi < smi.num_faces; ++fi) {
-        int ngon = counts[smi.begin_face + fi];
-        for (int ni = 0; ni < ngon; ++ni) {
-            dst[a + ni] = positions[indices[a + ni + smi.begin_index]];
-        }
-        a += ngon;
-    }
-    if (m_obj->getReverseX()) {
-        for (size_t i = 0; i < a; ++i) {
-            dst[i].x *= -1.0f;
-        }
-    }
+// index into the values of a geom param for face corner ci. corner_values comes from getCornerNormalIndices() or
+// getCornerUVIndices()
+static inline int aiCornerValueIndex(const int *corner_values, int ci)
+{
+    return corner_values ? corner_values[ci] : ci;
 }
 
-void aiPolyMesh::copySplitedNormals(abcV3 *dst, const aiSplitedMeshInfo &smi) const
+struct aiVertexKey
 {
-    const auto &counts = *m_counts;
-    const auto &normals = *m_normals.getVals();
-    const auto &indices = *m_normals.getIndices();
+    int position, normal, uv;
+    bool operator==(const aiVertexKey &o) const { return position == o.position && normal == o.normal && uv == o.uv; }
+};
 
-    if (m_normals.isIndexed())
+struct aiVertexKeyHasher
+{
+    size_t operator()(const aiVertexKey &k) const
     {
-        uint32_t a = 0;
-        for (int fi = 0; fi < smi.num_faces; ++fi) {
-            int ngon = counts[smi.begin_face + fi];
-            for (int ni = 0; ni < ngon; ++ni) {
-                dst[a + ni] = normals[indices[a + ni + smi.begin_index]];
-            }
-            a += ngon;
-        }
+        return size_t(k.position) * 73856093u ^ size_t(k.normal) * 19349663u ^ size_t(k.uv) * 83492791u;
     }
-    else
-    {
-        uint32_t a = 0;
-        for (int fi = 0; fi < smi.num_faces; ++fi) {
-            int ngon = counts[smi.begin_face + fi];
-            for (int ni = 0; ni < ngon; ++ni) {
-                dst[a + ni] = normals[a + ni];
+};
+
+// exclusive prefix sums of face corners and triangles, so that any range of faces knows where its output goes.
+// each block of faces is summed up in parallel first, then the offsets of the blocks are propagated in parallel.
+static void aiBuildFaceOffsets(const int *counts, size_t num_faces, std::vector<int> &index_offsets, std::vector<int> &triangle_offsets)
+{
+    index_offsets.resize(num_faces + 1);
+    triangle_offsets.resize(num_faces + 1);
+
+    size_t num_blocks = std::min<size_t>(aiGetNumTaskThreads(), std::max<size_t>(num_faces / aiMinElementsPerTask, 1));
+    size_t step = (num_faces + num_blocks - 1) / std::max<size_t>(num_blocks, 1);
+    std::vector<int> block_indices(num_blocks + 1), block_triangles(num_blocks + 1);
+
+    aiParallelFor(0, num_blocks, 1, [&](size_t bb, size_t be) {
+        for (size_t bi = bb; bi < be; ++bi) {
+            size_t end = std::min<size_t>((bi + 1) * step, num_faces);
+            int ni = 0, nt = 0;
+            for (size_t fi = bi * step; fi < end; ++fi) {
+                ni += counts[fi];
+                nt += std::max<int>(counts[fi] - 2, 0);
             }
-            a += ngon;
+            block_indices[bi + 1] = ni;
+            block_triangles[bi + 1] = nt;
         }
-        if (m_obj->getReverseX()) {
-            for (size_t i = 0; i < a; ++i) {
-                dst[i].x *= -1.0f;
+    });
+    for (size_t bi = 0; bi < num_blocks; ++bi) {
+        block_indices[bi + 1] += block_indices[bi];
+        block_triangles[bi + 1] += block_triangles[bi];
+    }
+    aiParallelFor(0, num_blocks, 1, [&](size_t bb, size_t be) {
+        for (size_t bi = bb; bi < be; ++bi) {
+            size_t end = std::min<size_t>((bi + 1) * step, num_faces);
+            int ni = block_indices[bi], nt = block_triangles[bi];
+            for (size_t fi = bi * step; fi < end; ++fi) {
+                index_offsets[fi] = ni;
+                triangle_offsets[fi] = nt;
+                ni += counts[fi];
+                nt += std::max<int>(counts[fi] - 2, 0);
             }
         }
-    }
+    });
+    index_offsets[num_faces] = block_indices[num_blocks];
+    triangle_offsets[num_faces] = block_triangles[num_blocks];
 }
 
-void aiPolyMesh::copySplitedUVs(abcV2 *dst, const aiSplitedMeshInfo &smi) const
+// reverse lookup of indices: the face corners of each position, as offsets into a flat list
+static void aiBuildVertexCorners(aiTopologyCache &tc, const int *indices, size_t num_indices, int num_positions)
 {
-    const auto &counts = *m_counts;
-    const auto &uvs = *m_uvs.getVals();
-    const auto &indices = *m_uvs.getIndices();
+    std::vector<int> &offsets = tc.vertex_corner_offsets;
+    offsets.assign(num_positions + 1, 0);
+    for (size_t ci = 0; ci < num_indices; ++ci) {
+        int i = indices[ci];
+        if (i >= 0 && i < num_positions) { ++offsets[i + 1]; }
+    }
+    for (int i = 0; i < num_positions; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
 
-    if (m_uvs.isIndexed())
-    {
-        uint32_t a = 0;
-        for (int fi = 0; fi < smi.num_faces; ++fi) {
-            int ngon = counts[smi.begin_face + fi];
-            for (int ni = 0; ni < ngon; ++ni) {
-                dst[a + ni] = uvs[indices[a + ni + smi.begin_index]];
+    std::vector<int> pos(offsets.begin(), offsets.end() - 1);
+    tc.vertex_corners.resize(offsets[num_positions]);
+    for (size_t ci = 0; ci < num_indices; ++ci) {
+        int i = indices[ci];
+        if (i >= 0 && i < num_positions) { tc.vertex_corners[pos[i]++] = (int)ci; }
+    }
+}
+
+// triangulates faces [begin_face, end_face) into dst. indices are taken from indices if it's not null,
+// otherwise they are face corners relative to the first corner of begin_face.
+static void aiTriangulateFaces(int *dst, const int *counts, const int *indices, const aiTopologyCache &tc,
+    size_t begin_face, size_t end_face, bool reverse_index)
+{
+    int i1 = reverse_index ? 2 : 1;
+    int i2 = reverse_index ? 1 : 2;
+    int base_index = tc.face_index_offsets[begin_face];
+    int base_triangle = tc.face_triangle_offsets[begin_face];
+
+    aiParallelFor(begin_face, end_face, aiMinElementsPerTask, [&](size_t fb, size_t fe) {
+        int *tri = dst + (tc.face_triangle_offsets[fb] - base_triangle) * 3;
+        for (size_t fi = fb; fi < fe; ++fi) {
+            int ngon = counts[fi];
+            int a = tc.face_index_offsets[fi];
+            if (indices) {
+                for (int ni = 0; ni < (ngon - 2); ++ni) {
+                    tri[0] = std::max<int>(indices[a], 0);
+                    tri[1] = std::max<int>(indices[a + i1 + ni], 0);
+                    tri[2] = std::max<int>(indices[a + i2 + ni], 0);
+                    tri += 3;
+                }
+            }
+            else {
+                a -= base_index;
+                for (int ni = 0; ni < (ngon - 2); ++ni) {
+                    tri[0] = a;
+                    tri[1] = a + i1 + ni;
+                    tri[2] = a + i2 + ni;
+                    tri += 3;
+                }
             }
-            a += ngon;
         }
+    });
+}
+
+aiTopologyCache& aiPolyMesh::getTopologyCache() const
+{
+    aiTopologyCache &tc = m_topology;
+    bool reverse_index = m_obj->getReverseIndex();
+    bool share_vertices = m_obj->getShareVertices();
+    // indices are re-read with their values, so they are compared by digest rather than by pointer
+    aiSampleState normal_indices, uv_indices;
+    if (share_vertices) {
+        if (m_normals.valid()) { normal_indices = m_normal_indices_state; }
+        if (m_uvs.valid()) { uv_indices = m_uv_indices_state; }
     }
-    else
+
+    if (tc.indices != m_indices || tc.counts != m_counts || tc.reverse_index != reverse_index || tc.share_vertices != share_vertices ||
+        !aiSameSample(tc.normal_indices, normal_indices) || !aiSameSample(tc.uv_indices, uv_indices))
     {
-        uint32_t a = 0;
-        for (int fi = 0; fi < smi.num_faces; ++fi) {
-            int ngon = counts[smi.begin_face + fi];
-            for (int ni = 0; ni < ngon; ++ni) {
-                dst[a + ni] = uvs[a + ni];
-            }
-            a += ngon;
-        }
+        tc = aiTopologyCache();
+        tc.indices = m_indices;
+        tc.counts = m_counts;
+        tc.normal_indices = normal_indices;
+        tc.uv_indices = uv_indices;
+        tc.reverse_index = reverse_index;
+        tc.share_vertices = share_vertices;
+
+        aiBuildFaceOffsets(m_counts->get(), m_counts->size(), tc.face_index_offsets, tc.face_triangle_offsets);
+        tc.triangulated_index_count = tc.face_triangle_offsets.back() * 3;
     }
+    return tc;
 }
 
+// index into the values of samp of each face corner. uniform values are per face, constant ones are one for all,
+// vertex and varying ones are per position. the param's own indices, the face indices or the face corners
+// themselves are used as they are if they are all in range. otherwise a table of them clamped to the values is
+// made once for the topology and the param's indices.
+// returns null if the face corners are the indices.
+template<class GeomParamSample>
+static const int* aiGetCornerValueIndices(const GeomParamSample &samp, const aiSampleState &indices_state,
+    const Abc::Int32ArraySample &indices, const aiTopologyCache &tc, aiCornerValueIndices &cv)
+{
+    size_t num_corners = indices.size();
+    size_t num_values = samp.getVals()->size();
+    bool indexed = samp.isIndexed();
+    AbcGeom::GeometryScope scope = samp.getScope();
+
+    // indices of geom params are unsigned. any past the int range is negative here and gets clamped like the rest
+    const int *src = nullptr;
+    size_t num_src = num_corners;
+    if (indexed) {
+        src = (const int*)samp.getIndices()->get();
+        num_src = samp.getIndices()->size();
+    }
+    else if (scope == AbcGeom::kVertexScope || scope == AbcGeom::kVaryingScope) {
+        src = indices.get();
+    }
+
+    if (!cv.valid || cv.num_values != num_values || !aiSameSample(cv.indices, indices_state)) {
+        cv.valid = true;
+        cv.num_values = num_values;
+        cv.indices = indices_state;
+        cv.table.clear();
+
+        bool in_range = false;
+        if (src && num_src >= num_corners) {
+            std::atomic<bool> out_of_range(false);
+            aiParallelFor(0, num_corners, aiMinElementsPerTask, [&](size_t b, size_t e) {
+                for (size_t ci = b; ci < e; ++ci) {
+                    if (src[ci] < 0 || (size_t)src[ci] >= num_values) {
+                        out_of_range = true;
+                        break;
+                    }
+                }
+            });
+            in_range = !out_of_range;
+        }
+        else if (!indexed && scope == AbcGeom::kFacevaryingScope) {
+            in_range = num_values >= num_corners;
+        }
+
+        if (!in_range) {
+            int last = std::max<int>((int)num_values - 1, 0);
+            cv.table.resize(num_corners);
+            int *dst = cv.table.data();
+            aiParallelFor(0, tc.face_index_offsets.size() - 1, aiMinElementsPerTask, [&](size_t fb, size_t fe) {
+                for (size_t fi = fb; fi < fe; ++fi) {
+                    for (int ci = tc.face_index_offsets[fi]; ci < tc.face_index_offsets[fi + 1]; ++ci) {
+                        int i = 0;
+                        if (src) { i = (size_t)ci < num_src ? src[ci] : 0; }
+                        else if (scope == AbcGeom::kUniformScope) { i = (int)fi; }
+                        else if (scope != AbcGeom::kConstantScope) { i = ci; }
+                        dst[ci] = std::max<int>(std::min<int>(i, last), 0);
+                    }
+                }
+            });
+        }
+    }
+    return cv.table.empty() ? src : cv.table.data();
+}
+
+const int* aiPolyMesh::getCornerNormalIndices() const
+{
+    aiTopologyCache &tc = getTopologyCache();
+    return aiGetCornerValueIndices(m_normals, m_normal_indices_state, *m_indices, tc, tc.normal_values);
+}
+
+const int* aiPolyMesh::getCornerUVIndices() const
+{
+    aiTopologyCache &tc = getTopologyCache();
+    return aiGetCornerValueIndices(m_uvs, m_uv_indices_state, *m_indices, tc, tc.uv_values);
+}
+
+uint32_t aiPolyMesh::getIndexCount() const
+{
+    // baked caches only hold triangulated splits. the whole mesh is those one after another
+    if (m_baked) { return m_baked_frame ? m_baked_frame->num_indices : 0; }
+
+    if (m_obj->getTriangulate())
+    {
+        return getTopologyCache().triangulated_index_count;
+    }
+    else
+    {
+        return m_indices->size();
+    }
+}
+
+uint32_t aiPolyMesh::getVertexCount() const
+{
+    if (m_baked) { return m_baked_frame ? m_baked_frame->num_vertices : 0; }
+    return m_positions->size();
+}
+
+void aiPolyMesh::copyIndices(int *dst) const
+{
+    if (m_baked) {
+        // split indices are relative to the split's first vertex
+        if (!m_baked_frame) { return; }
+        const int *indices = m_baked->get<int>(m_baked_frame->indices);
+        const aiSplitedMeshInfo *splits = m_baked->get<aiSplitedMeshInfo>(m_baked_frame->splits);
+        for (uint32_t si = 0; si < m_baked_frame->num_splits; ++si) {
+            int offset = m_baked_index_offsets[si];
+            int base = m_baked_vertex_offsets[si];
+            aiParallelFor(0, (size_t)splits[si].triangulated_index_count, aiMinElementsPerTask, [&](size_t b, size_t e) {
+                for (size_t i = b; i < e; ++i) {
+                    dst[offset + i] = indices[offset + i] + base;
+                }
+            });
+        }
+        return;
+    }
+    bool reverse_index = m_obj->getReverseIndex();
+
+    if (m_obj->getTriangulate())
+    {
+        aiTopologyCache &tc = getTopologyCache();
+        if (tc.triangulated_indices.empty() && tc.triangulated_index_count > 0)
+        {
+            tc.triangulated_indices.resize(tc.triangulated_index_count);
+            aiTriangulateFaces(&tc.triangulated_indices[0], m_counts->get(), m_indices->get(), tc,
+                0, m_counts->size(), reverse_index);
+        }
+        if (!tc.triangulated_indices.empty()) {
+            aiParallelCopy(dst, &tc.triangulated_indices[0], tc.triangulated_indices.size());
+        }
+    }
+    else
+    {
+        aiParallelCopyIndices(dst, m_indices->get(), m_indices->size(), reverse_index);
+    }
+}
+
+void aiPolyMesh::copyVertices(abcV3 *dst) const
+{
+    aiParallelCopyPoints(dst, getPositions(), getVertexCount(), m_obj->getReverseX());
+}
+
+// whole mesh copies are per position, so each position takes the value of the first face corner that refers to it.
+// corner_values comes from getCornerNormalIndices() or getCornerUVIndices(). positions no face refers to take the
+// first value
+void aiPolyMesh::buildPositionValueIndices(const int *corner_values, std::vector<int> &dst) const
+{
+    updateVertexCorners();
+    const aiTopologyCache &tc = m_topology;
+    size_t num_positions = m_positions->size();
+    dst.resize(num_positions);
+    aiParallelFor(0, num_positions, aiMinElementsPerTask, [&](size_t vb, size_t ve) {
+        for (size_t vi = vb; vi < ve; ++vi) {
+            int first = tc.vertex_corner_offsets[vi];
+            dst[vi] = first < tc.vertex_corner_offsets[vi + 1] ? aiCornerValueIndex(corner_values, tc.vertex_corners[first]) : 0;
+        }
+    });
+}
+
+void aiPolyMesh::copyNormals(abcV3 *dst) const
+{
+    bool reverse_x = m_obj->getReverseX();
+    if (m_baked) {
+        if (m_baked_frame && m_baked_frame->normals) {
+            aiParallelCopyPoints(dst, m_baked->get<abcV3>(m_baked_frame->normals), m_baked_frame->num_vertices, reverse_x);
+        }
+        return;
+    }
+    size_t num_positions = m_positions->size();
+    if (hasGeneratedNormals()) {
+        aiParallelCopyPoints(dst, getGeneratedNormals(), num_positions, reverse_x);
+        return;
+    }
+    if (!m_normals.valid() || m_normals.getVals()->size() == 0) { return; }
+
+    const int *corners = getCornerNormalIndices();
+    if (corners == m_indices->get() && m_normals.getVals()->size() >= num_positions) {
+        // already per position
+        aiParallelCopyPoints(dst, getNormalValues(), num_positions, reverse_x);
+        return;
+    }
+    std::vector<int> values;
+    buildPositionValueIndices(corners, values);
+    aiParallelGatherPoints(dst, getNormalValues(), values.data(), num_positions, reverse_x);
+}
+
+// builds the position -> face corners table if the topology changed since. returns true if it was rebuilt
+bool aiPolyMesh::updateVertexCorners() const
+{
+    aiTopologyCache &tc = getTopologyCache();
+    size_t num_positions = m_positions->size();
+    if (tc.vertex_corner_offsets.size() == num_positions + 1) {
+        return false;
+    }
+    aiBuildVertexCorners(tc, m_indices->get(), m_indices->size(), (int)num_positions);
+    return true;
+}
+
+// smooth normal of each position: the sum of the normals of the faces around it, each weighted by the face's
+// area and the angle of its corner at the position. computed on the whole mesh so that splits have no seams.
+// faces are processed in parallel into per-corner normals, then each position gathers its corners, so no two
+// threads ever write the same element.
+const abcV3* aiPolyMesh::getGeneratedNormals() const
+{
+    const aiTopologyCache &tc = getTopologyCache();
+    const int *counts = m_counts->get();
+    const int *indices = m_indices->get();
+    const abcV3 *positions = getPositions();
+    size_t num_faces = m_counts->size();
+    size_t num_indices = m_indices->size();
+    int num_positions = (int)m_positions->size();
+
+    if (updateVertexCorners()) {
+        m_generated_normals_dirty = true;
+    }
+    if (!m_generated_normals_dirty) {
+        return m_generated_normals.data();
+    }
+    m_generated_normals_dirty = false;
+    m_generated_normals.resize(num_positions);
+    m_corner_normals.resize(num_indices);
+
+    auto position_of = [&](int ci) -> abcV3 {
+        int i = indices[ci];
+        return i >= 0 && i < num_positions ? positions[i] : abcV3(0.0f);
+    };
+    aiParallelFor(0, num_faces, aiMinElementsPerTask, [&](size_t fb, size_t fe) {
+        for (size_t fi = fb; fi < fe; ++fi) {
+            int ngon = counts[fi];
+            int a = tc.face_index_offsets[fi];
+
+            // Newell's method. its length is twice the area of the face.
+            // alembic faces are clockwise, so the sum is negated to point outward
+            abcV3 face_normal(0.0f);
+            for (int ni = 0; ni < ngon; ++ni) {
+                face_normal -= position_of(a + ni).cross(position_of(a + (ni + 1) % ngon));
+            }
+            for (int ni = 0; ni < ngon; ++ni) {
+                abcV3 p = position_of(a + ni);
+                abcV3 e0 = position_of(a + (ni + ngon - 1) % ngon) - p;
+                abcV3 e1 = position_of(a + (ni + 1) % ngon) - p;
+                float l = e0.length() * e1.length();
+                float angle = l > 0.0f ? std::acos(std::max(-1.0f, std::min(1.0f, e0.dot(e1) / l))) : 0.0f;
+                m_corner_normals[a + ni] = face_normal * angle;
+            }
+        }
+    });
+
+    aiParallelFor(0, num_positions, aiMinElementsPerTask, [&](size_t vb, size_t ve) {
+        for (size_t vi = vb; vi < ve; ++vi) {
+            abcV3 n(0.0f);
+            int end = tc.vertex_corner_offsets[vi + 1];
+            for (int i = tc.vertex_corner_offsets[vi]; i < end; ++i) {
+                n += m_corner_normals[tc.vertex_corners[i]];
+            }
+            float l = n.length();
+            m_generated_normals[vi] = l > 0.0f ? n / l : abcV3(0.0f, 1.0f, 0.0f);
+        }
+    });
+    return m_generated_normals.data();
+}
+
+// tangent of each face corner, from the uv gradient of the triangle made by the corner and its two neighbors.
+// like the generated normals these are weighted by the corner angle and summed up over the corners that share
+// the position and the uv, then made orthogonal to the corner's normal. w is the handedness of the bitangent.
+const abcV4* aiPolyMesh::getTangents() const
+{
+    if (updateVertexCorners()) {
+        m_tangents_dirty = true;
+    }
+    if (!m_tangents_dirty) {
+        return m_tangents.data();
+    }
+    m_tangents_dirty = false;
+
+    const aiTopologyCache &tc = m_topology;
+    const auto &indices = *m_indices;
+    const int *counts = m_counts->get();
+    const abcV3 *positions = getPositions();
+    const abcV2 *uvs = m_uvs.getVals()->get();
+    const abcV3 *generated_normals = hasGeneratedNormals() ? getGeneratedNormals() : nullptr;
+    const abcV3 *normals = generated_normals ? nullptr : getNormalValues();
+    const int *uv_corners = getCornerUVIndices();
+    const int *normal_corners = generated_normals ? nullptr : getCornerNormalIndices();
+    size_t num_faces = m_counts->size();
+    size_t num_indices = indices.size();
+    int num_positions = (int)m_positions->size();
+
+    m_tangents.resize(num_indices);
+    m_corner_tangents.resize(num_indices);
+    m_corner_bitangents.resize(num_indices);
+
+    auto position_of = [&](int ci) -> abcV3 {
+        int i = indices[ci];
+        return i >= 0 && i < num_positions ? positions[i] : abcV3(0.0f);
+    };
+    auto uv_of = [&](int ci) -> abcV2 {
+        return uvs[aiCornerValueIndex(uv_corners, ci)];
+    };
+    auto normal_of = [&](int ci) -> abcV3 {
+        if (generated_normals) {
+            int i = indices[ci];
+            return i >= 0 && i < num_positions ? generated_normals[i] : abcV3(0.0f);
+        }
+        return normals[aiCornerValueIndex(normal_corners, ci)];
+    };
+
+    aiParallelFor(0, num_faces, aiMinElementsPerTask, [&](size_t fb, size_t fe) {
+        for (size_t fi = fb; fi < fe; ++fi) {
+            int ngon = counts[fi];
+            int a = tc.face_index_offsets[fi];
+            for (int ni = 0; ni < ngon; ++ni) {
+                int c0 = a + ni, c1 = a + (ni + 1) % ngon, c2 = a + (ni + ngon - 1) % ngon;
+                abcV3 p = position_of(c0);
+                abcV3 e1 = position_of(c1) - p, e2 = position_of(c2) - p;
+                abcV2 uv = uv_of(c0);
+                abcV2 d1 = uv_of(c1) - uv, d2 = uv_of(c2) - uv;
+
+                abcV3 t(0.0f), b(0.0f);
+                float det = d1.x * d2.y - d2.x * d1.y;
+                float l = e1.length() * e2.length();
+                if (det != 0.0f && l > 0.0f) {
+                    float angle = std::acos(std::max(-1.0f, std::min(1.0f, e1.dot(e2) / l)));
+                    t = ((e1 * d2.y - e2 * d1.y) / det).normalized() * angle;
+                    b = ((e2 * d1.x - e1 * d2.x) / det).normalized() * angle;
+                }
+                m_corner_tangents[c0] = t;
+                m_corner_bitangents[c0] = b;
+            }
+        }
+    });
+
+    aiParallelFor(0, num_indices, aiMinElementsPerTask, [&](size_t cb, size_t ce) {
+        for (size_t ci = cb; ci < ce; ++ci) {
+            abcV3 t(0.0f), b(0.0f);
+            int vi = indices[ci];
+            if (vi >= 0 && vi < num_positions) {
+                // corners across a uv seam don't share their tangents
+                abcV2 uv = uv_of((int)ci);
+                int end = tc.vertex_corner_offsets[vi + 1];
+                for (int i = tc.vertex_corner_offsets[vi]; i < end; ++i) {
+                    int c = tc.vertex_corners[i];
+                    if (uv_of(c) == uv) {
+                        t += m_corner_tangents[c];
+                        b += m_corner_bitangents[c];
+                    }
+                }
+            }
+
+            // Gram-Schmidt
+            abcV3 n = normal_of((int)ci);
+            t = (t - n * n.dot(t));
+            float l = t.length();
+            t = l > 0.0f ? t / l : abcV3(1.0f, 0.0f, 0.0f);
+            float w = n.cross(t).dot(b) < 0.0f ? -1.0f : 1.0f;
+            m_tangents[ci] = abcV4(t.x, t.y, t.z, w);
+        }
+    });
+    return m_tangents.data();
+}
+
+void aiPolyMesh::copyUVs(abcV2 *dst) const
+{
+    if (m_baked) {
+        if (m_baked_frame && m_baked_frame->uvs) {
+            aiParallelCopy(dst, m_baked->get<abcV2>(m_baked_frame->uvs), m_baked_frame->num_vertices);
+        }
+        return;
+    }
+    if (!m_uvs.valid() || m_uvs.getVals()->size() == 0) { return; }
+
+    const abcV2 *uvs = m_uvs.getVals()->get();
+    size_t num_positions = m_positions->size();
+    const int *corners = getCornerUVIndices();
+    if (corners == m_indices->get() && m_uvs.getVals()->size() >= num_positions) {
+        // already per position
+        aiParallelCopy(dst, uvs, num_positions);
+        return;
+    }
+    std::vector<int> values;
+    buildPositionValueIndices(corners, values);
+    aiParallelGatherPoints(dst, uvs, values.data(), num_positions);
+}
+
+// splits the whole mesh into ranges of faces with less than max_vertices vertices each, and triangulates
+// each range with indices relative to its first vertex.
+// without share_vertices every face corner is a vertex of its own. with share_vertices corners that refer to
+// the same position, normal and uv are welded, and the split_vertex_* remap tables refer to their data.
+void aiPolyMesh::buildSplits(aiTopologyCache &tc, int max_vertices) const
+{
+    const auto &counts = *m_counts;
+    const auto &indices = *m_indices;
+    int nc = (int)counts.size();
+
+    tc.max_vertices = max_vertices;
+    tc.splits.clear();
+    tc.split_index_offsets.clear();
+    tc.split_indices.clear();
+    tc.split_indices.reserve(tc.triangulated_index_count);
+    tc.split_vertex_offsets.clear();
+    tc.split_vertex_positions.clear();
+    tc.split_vertex_normals.clear();
+    tc.split_vertex_uvs.clear();
+    tc.split_vertex_corners.clear();
+    tc.last_split = 0;
+
+    bool share = tc.share_vertices;
+    bool has_normals = m_normals.valid();
+    bool has_uvs = m_uvs.valid();
+    const int *normal_corners = share && has_normals ? getCornerNormalIndices() : nullptr;
+    const int *uv_corners = share && has_uvs ? getCornerUVIndices() : nullptr;
+    std::unordered_map<aiVertexKey, int, aiVertexKeyHasher> vertex_map;
+    std::vector<int> remap; // face corner -> vertex, for the current face
+
+    uint32_t i1 = tc.reverse_index ? 2 : 1;
+    uint32_t i2 = tc.reverse_index ? 1 : 2;
+
+    aiSplitedMeshInfo smi = {};
+    for (;;) {
+        smi.begin_face += smi.num_faces;
+        smi.begin_index += smi.num_indices;
+        smi.num_faces = 0;
+        smi.num_indices = 0;
+        smi.num_vertices = 0;
+        smi.triangulated_index_count = 0;
+        tc.split_index_offsets.push_back((int)tc.split_indices.size());
+        tc.split_vertex_offsets.push_back((int)tc.split_vertex_positions.size());
+        vertex_map.clear();
+
+        int a = 0; // face corners
+        int v = 0; // vertices
+        int fi = smi.begin_face;
+        for (; fi < nc; ++fi) {
+            int ngon = counts[fi];
+            // a face that can't fit at all gets a split of its own rather than looping forever
+            if (v + ngon >= max_vertices && smi.num_faces > 0) {
+                break;
+            }
+
+            if (share) {
+                remap.resize(ngon);
+                for (int ni = 0; ni < ngon; ++ni) {
+                    int ci = smi.begin_index + a + ni;
+                    aiVertexKey key = {
+                        indices[ci],
+                        has_normals ? aiCornerValueIndex(normal_corners, ci) : -1,
+                        has_uvs ? aiCornerValueIndex(uv_corners, ci) : -1,
+                    };
+                    auto r = vertex_map.insert(std::make_pair(key, v));
+                    if (r.second) {
+                        tc.split_vertex_positions.push_back(key.position);
+                        if (has_normals) { tc.split_vertex_normals.push_back(key.normal); }
+                        if (has_uvs) { tc.split_vertex_uvs.push_back(key.uv); }
+                        tc.split_vertex_corners.push_back(ci);
+                        ++v;
+                    }
+                    remap[ni] = r.first->second;
+                }
+                for (int ni = 0; ni < (ngon - 2); ++ni) {
+                    tc.split_indices.push_back(remap[0]);
+                    tc.split_indices.push_back(remap[i1 + ni]);
+                    tc.split_indices.push_back(remap[i2 + ni]);
+                }
+            }
+            else {
+                for (int ni = 0; ni < (ngon - 2); ++ni) {
+                    tc.split_indices.push_back(a);
+                    tc.split_indices.push_back(a + i1 + ni);
+                    tc.split_indices.push_back(a + i2 + ni);
+                }
+                v += ngon;
+            }
+            a += ngon;
+            smi.num_faces++;
+            smi.num_indices = a;
+            smi.triangulated_index_count += (ngon - 2) * 3;
+        }
+        smi.num_vertices = v;
+        tc.splits.push_back(smi);
+
+        if (fi >= nc) { break; }
+    }
+}
+
+int aiPolyMesh::findSplit(const aiSplitedMeshInfo &smi) const
+{
+    aiTopologyCache &tc = m_topology;
+    size_t n = tc.splits.size();
+
+    // splits are almost always requested in order
+    for (size_t i = tc.last_split; i < n && i <= tc.last_split + 1; ++i) {
+        if (tc.splits[i].begin_face == smi.begin_face) {
+            tc.last_split = i;
+            return (int)i;
+        }
+    }
+    auto it = std::lower_bound(tc.splits.begin(), tc.splits.end(), smi.begin_face,
+        [](const aiSplitedMeshInfo &s, int begin_face) { return s.begin_face < begin_face; });
+    if (it != tc.splits.end() && it->begin_face == smi.begin_face) {
+        tc.last_split = std::distance(tc.splits.begin(), it);
+        return (int)tc.last_split;
+    }
+    return -1;
+}
+
+// split of smi if vertices are shared. -1 otherwise
+int aiPolyMesh::findSharedVertexSplit(const aiSplitedMeshInfo &smi) const
+{
+    if (!m_obj->getShareVertices()) { return -1; }
+
+    aiTopologyCache &tc = getTopologyCache();
+    int si = tc.splits.empty() ? -1 : findSplit(smi);
+    if (si < 0 || tc.splits[si].num_faces != smi.num_faces) { return -1; }
+    return si;
+}
+
+// split of smi in the current frame of a baked cache. -1 if it isn't one of them
+int aiPolyMesh::findBakedSplit(const aiSplitedMeshInfo &smi) const
+{
+    if (!m_baked_frame) { return -1; }
+
+    const aiSplitedMeshInfo *begin = m_baked->get<aiSplitedMeshInfo>(m_baked_frame->splits);
+    const aiSplitedMeshInfo *end = begin + m_baked_frame->num_splits;
+    auto it = std::lower_bound(begin, end, smi.begin_face,
+        [](const aiSplitedMeshInfo &s, int begin_face) { return s.begin_face < begin_face; });
+    if (it == end || it->begin_face != smi.begin_face || it->num_faces != smi.num_faces) { return -1; }
+    return int(it - begin);
+}
+
+bool aiPolyMesh::getSplitedMeshInfo(aiSplitedMeshInfo &o_smi, const aiSplitedMeshInfo& prev, int max_vertices) const
+{
+    if (m_baked) {
+        aiSplitedMeshInfo next = {};
+        next.begin_face = prev.begin_face + prev.num_faces;
+        next.begin_index = prev.begin_index + prev.num_indices;
+        int n = m_baked_frame ? (int)m_baked_frame->num_splits : 0;
+        const aiSplitedMeshInfo *splits = n > 0 ? m_baked->get<aiSplitedMeshInfo>(m_baked_frame->splits) : nullptr;
+        auto it = std::lower_bound(splits, splits + n, next.begin_face,
+            [](const aiSplitedMeshInfo &s, int begin_face) { return s.begin_face < begin_face; });
+        if (it == splits + n || it->begin_face != next.begin_face) {
+            // past the end
+            o_smi = next;
+            return true;
+        }
+        o_smi = *it;
+        return it + 1 == splits + n;
+    }
+
+    aiTopologyCache &tc = getTopologyCache();
+    if (tc.splits.empty() || tc.max_vertices != max_vertices) {
+        buildSplits(tc, max_vertices);
+    }
+
+    aiSplitedMeshInfo next = {};
+    next.begin_face = prev.begin_face + prev.num_faces;
+    int si = findSplit(next);
+    if (si < 0) {
+        // past the end
+        next.begin_index = prev.begin_index + prev.num_indices;
+        o_smi = next;
+        return true;
+    }
+    o_smi = tc.splits[si];
+    return si + 1 == (int)tc.splits.size();
+}
+
+void aiPolyMesh::copySplitedIndices(int *dst, const aiSplitedMeshInfo &smi) const
+{
+    if (m_baked) {
+        int si = findBakedSplit(smi);
+        if (si >= 0 && smi.triangulated_index_count > 0) {
+            aiParallelCopy(dst, m_baked->get<int>(m_baked_frame->indices) + m_baked_index_offsets[si], smi.triangulated_index_count);
+        }
+        return;
+    }
+
+    aiTopologyCache &tc = getTopologyCache();
+    int si = tc.splits.empty() ? -1 : findSplit(smi);
+    if (si >= 0 && tc.splits[si].num_faces == smi.num_faces)
+    {
+        if (smi.triangulated_index_count > 0) {
+            aiParallelCopy(dst, &tc.split_indices[tc.split_index_offsets[si]], smi.triangulated_index_count);
+        }
+        return;
+    }
+
+    // smi doesn't come from getSplitedMeshInfo() with the current topology
+    aiTriangulateFaces(dst, m_counts->get(), nullptr, tc, smi.begin_face, smi.begin_face + smi.num_faces, tc.reverse_index);
+}
+
+// vertices of baked splits are stored as they are copied, so they have no indices. an unknown split has no vertices
+template<class T>
+static aiSplitSource<T> aiGetBakedSplitSource(const T *values, const std::vector<int> &vertex_offsets, int si, const aiSplitedMeshInfo &smi)
+{
+    aiSplitSource<T> ret = { nullptr, nullptr, 0 };
+    if (values && si >= 0) {
+        ret.values = values + vertex_offsets[si];
+        ret.num = (size_t)smi.num_vertices;
+    }
+    return ret;
+}
+
+aiSplitSource<abcV3> aiPolyMesh::getSplitPositions(const aiSplitedMeshInfo &smi) const
+{
+    if (m_baked) {
+        return aiGetBakedSplitSource(getPositions(), m_baked_vertex_offsets, findBakedSplit(smi), smi);
+    }
+
+    const abcV3 *positions = getPositions();
+
+    int si = findSharedVertexSplit(smi);
+    if (si >= 0)
+    {
+        const aiTopologyCache &tc = m_topology;
+        aiSplitSource<abcV3> ret = { positions, tc.split_vertex_positions.data() + tc.split_vertex_offsets[si], (size_t)smi.num_vertices };
+        return ret;
+    }
+    else
+    {
+        aiSplitSource<abcV3> ret = { positions, m_indices->get() + smi.begin_index, (size_t)smi.num_indices };
+        return ret;
+    }
+}
+
+aiSplitSource<abcV3> aiPolyMesh::getSplitNormals(const aiSplitedMeshInfo &smi) const
+{
+    if (m_baked) {
+        const abcV3 *normals = m_baked_frame ? m_baked->get<abcV3>(m_baked_frame->normals) : nullptr;
+        return aiGetBakedSplitSource(normals, m_baked_vertex_offsets, findBakedSplit(smi), smi);
+    }
+
+    if (hasGeneratedNormals())
+    {
+        // per position, like the positions themselves
+        aiSplitSource<abcV3> ret = getSplitPositions(smi);
+        ret.values = getGeneratedNormals();
+        return ret;
+    }
+
+    const abcV3 *normals = getNormalValues();
+
+    int si = findSharedVertexSplit(smi);
+    if (si >= 0)
+    {
+        const aiTopologyCache &tc = m_topology;
+        aiSplitSource<abcV3> ret = { normals, tc.split_vertex_normals.data() + tc.split_vertex_offsets[si], (size_t)smi.num_vertices };
+        return ret;
+    }
+    else if (const int *corners = getCornerNormalIndices())
+    {
+        aiSplitSource<abcV3> ret = { normals, corners + smi.begin_index, (size_t)smi.num_indices };
+        return ret;
+    }
+    else
+    {
+        aiSplitSource<abcV3> ret = { normals + smi.begin_index, nullptr, (size_t)smi.num_indices };
+        return ret;
+    }
+}
+
+aiSplitSource<abcV2> aiPolyMesh::getSplitUVs(const aiSplitedMeshInfo &smi) const
+{
+    if (m_baked) {
+        const abcV2 *uvs = m_baked_frame ? m_baked->get<abcV2>(m_baked_frame->uvs) : nullptr;
+        return aiGetBakedSplitSource(uvs, m_baked_vertex_offsets, findBakedSplit(smi), smi);
+    }
+
+    const abcV2 *uvs = m_uvs.getVals()->get();
+
+    int si = findSharedVertexSplit(smi);
+    if (si >= 0)
+    {
+        const aiTopologyCache &tc = m_topology;
+        aiSplitSource<abcV2> ret = { uvs, tc.split_vertex_uvs.data() + tc.split_vertex_offsets[si], (size_t)smi.num_vertices };
+        return ret;
+    }
+    else if (const int *corners = getCornerUVIndices())
+    {
+        aiSplitSource<abcV2> ret = { uvs, corners + smi.begin_index, (size_t)smi.num_indices };
+        return ret;
+    }
+    else
+    {
+        aiSplitSource<abcV2> ret = { uvs + smi.begin_index, nullptr, (size_t)smi.num_indices };
+        return ret;
+    }
+}
+
+void aiPolyMesh::copySplitedVertices(abcV3 *dst, const aiSplitedMeshInfo &smi) const
+{
+    aiSplitSource<abcV3> src = getSplitPositions(smi);
+    if (src.indices) {
+        aiParallelGatherPoints(dst, src.values, src.indices, src.num, m_obj->getReverseX());
+    }
+    else {
+        aiParallelCopyPoints(dst, src.values, src.num, m_obj->getReverseX());
+    }
+}
+
+void aiPolyMesh::copySplitedNormals(abcV3 *dst, const aiSplitedMeshInfo &smi) const
+{
+    aiSplitSource<abcV3> src = getSplitNormals(smi);
+    if (src.indices) {
+        aiParallelGatherPoints(dst, src.values, src.indices, src.num, m_obj->getReverseX());
+    }
+    else {
+        aiParallelCopyPoints(dst, src.values, src.num, m_obj->getReverseX());
+    }
+}
+
+void aiPolyMesh::copySplitedUVs(abcV2 *dst, const aiSplitedMeshInfo &smi) const
+{
+    aiSplitSource<abcV2> src = getSplitUVs(smi);
+    if (src.indices) {
+        aiParallelGatherPoints(dst, src.values, src.indices, src.num);
+    }
+    else {
+        aiParallelCopy(dst, src.values, src.num);
+    }
+}
+
+static bool aiIsVertexFormatOf(int attribute, int format)
+{
+    switch (attribute) {
+    case aiMeshProperty_Positions: return format == aiVertexFormat_Float || format == aiVertexFormat_Half4 || format == aiVertexFormat_UNorm16x4;
+    case aiMeshProperty_Normals:   return format == aiVertexFormat_Float || format == aiVertexFormat_Oct16;
+    case aiMeshProperty_UVs:       return format == aiVertexFormat_Float || format == aiVertexFormat_UNorm16x2;
+    }
+    return false;
+}
+
+// f(first element, number of elements, values, indices) on ranges of src, values and indices offset to the range
+template<class T, class F>
+static void aiParallelForSource(const aiSplitSource<T> &src, const F &f)
+{
+    aiParallelFor(0, src.num, aiMinElementsPerTask, [&](size_t b, size_t e) {
+        if (src.indices) { f(b, e - b, src.values, src.indices + b); }
+        else { f(b, e - b, src.values + b, (const int*)nullptr); }
+    });
+}
+
+// from the extent of the bounds to what maps them onto [0, 65535]
+template<class T>
+static T aiUNorm16EncodeScale(const T &extent)
+{
+    T ret;
+    for (unsigned c = 0; c < T::dimensions(); ++c) {
+        ret[c] = extent[c] > 0.0f ? 65535.0f / extent[c] : 0.0f;
+    }
+    return ret;
+}
+
+void aiPolyMesh::copySplitedAttribute(void *dst, const aiSplitedMeshInfo &smi, int attribute, int format) const
+{
+    if (!aiIsVertexFormatOf(attribute, format)) { return; }
+
+    bool reverse_x = m_obj->getReverseX();
+    switch (format) {
+    case aiVertexFormat_Float:
+        if (attribute == aiMeshProperty_Positions)    { copySplitedVertices((abcV3*)dst, smi); }
+        else if (attribute == aiMeshProperty_Normals) { copySplitedNormals((abcV3*)dst, smi); }
+        else                                          { copySplitedUVs((abcV2*)dst, smi); }
+        break;
+
+    case aiVertexFormat_Half4:
+        aiParallelForSource(getSplitPositions(smi), [&](size_t b, size_t n, const abcV3 *values, const int *indices) {
+            aiQuantizePointsHalf((uint16_t*)dst + b * 4, values, indices, n, reverse_x);
+        });
+        break;
+
+    case aiVertexFormat_UNorm16x4:
+    {
+        const aiQuantizationParams &qp = getQuantizationParams();
+        abcV3 scale = aiUNorm16EncodeScale(qp.position_scale);
+        aiParallelForSource(getSplitPositions(smi), [&](size_t b, size_t n, const abcV3 *values, const int *indices) {
+            aiQuantizePointsUNorm16((uint16_t*)dst + b * 4, values, indices, n, qp.position_offset, scale, reverse_x);
+        });
+        break;
+    }
+
+    case aiVertexFormat_Oct16:
+        aiParallelForSource(getSplitNormals(smi), [&](size_t b, size_t n, const abcV3 *values, const int *indices) {
+            aiQuantizeNormalsOct16((int16_t*)dst + b * 2, values, indices, n, reverse_x);
+        });
+        break;
+
+    case aiVertexFormat_UNorm16x2:
+    {
+        const aiQuantizationParams &qp = getQuantizationParams();
+        abcV2 scale = aiUNorm16EncodeScale(qp.uv_scale);
+        aiParallelForSource(getSplitUVs(smi), [&](size_t b, size_t n, const abcV2 *values, const int *indices) {
+            aiQuantizeUVsUNorm16((uint16_t*)dst + b * 2, values, indices, n, qp.uv_offset, scale);
+        });
+        break;
+    }
+    }
+}
+
+template<class T>
+static void aiParallelComputeBounds(const T *src, size_t num, T &o_min, T &o_max)
+{
+    if (num == 0) {
+        o_min = o_max = T(0.0f);
+        return;
+    }
+    o_min = T(std::numeric_limits<float>::max());
+    o_max = T(-std::numeric_limits<float>::max());
+    std::mutex mutex;
+    aiParallelFor(0, num, aiMinElementsPerTask, [&](size_t b, size_t e) {
+        T bmin(std::numeric_limits<float>::max()), bmax(-std::numeric_limits<float>::max());
+        aiComputeBounds(src + b, e - b, bmin, bmax);
+        std::unique_lock<std::mutex> lock(mutex);
+        aiComputeBounds(&bmin, 1, o_min, o_max);
+        aiComputeBounds(&bmax, 1, o_min, o_max);
+    });
+}
+
+const aiQuantizationParams& aiPolyMesh::getQuantizationParams() const
+{
+    bool reverse_x = m_obj->getReverseX();
+    if (m_position_bounds_dirty || m_bounds_reverse_x != reverse_x) {
+        abcV3 bmin, bmax;
+        size_t num_positions = m_baked ? (m_baked_frame ? m_baked_frame->num_vertices : 0) : m_positions->size();
+        aiParallelComputeBounds(getPositions(), num_positions, bmin, bmax);
+        if (reverse_x) {
+            std::swap(bmin.x, bmax.x);
+            bmin.x *= -1.0f;
+            bmax.x *= -1.0f;
+        }
+        m_quantization.position_offset = bmin;
+        m_quantization.position_scale = bmax - bmin;
+        m_position_bounds_dirty = false;
+        m_bounds_reverse_x = reverse_x;
+    }
+    if (m_uv_bounds_dirty) {
+        abcV2 bmin(0.0f), bmax(0.0f);
+        if (m_baked) {
+            if (hasUVs()) {
+                aiParallelComputeBounds(m_baked->get<abcV2>(m_baked_frame->uvs), m_baked_frame->num_vertices, bmin, bmax);
+            }
+        }
+        else if (m_uvs.valid()) {
+            aiParallelComputeBounds(m_uvs.getVals()->get(), m_uvs.getVals()->size(), bmin, bmax);
+        }
+        m_quantization.uv_offset = bmin;
+        m_quantization.uv_scale = bmax - bmin;
+        m_uv_bounds_dirty = false;
+    }
+    return m_quantization;
+}
+
+void aiPolyMesh::copySplitedTangents(abcV4 *dst, const aiSplitedMeshInfo &smi) const
+{
+    if (!hasTangents()) { return; }
+
+    bool reverse_x = m_obj->getReverseX();
+    const abcV4 *tangents = nullptr;
+    const int *corners = nullptr;
+    int num = 0;
+    if (m_baked) {
+        aiSplitSource<abcV4> src = aiGetBakedSplitSource(m_baked->get<abcV4>(m_baked_frame->tangents), m_baked_vertex_offsets, findBakedSplit(smi), smi);
+        tangents = src.values;
+        num = (int)src.num;
+    }
+    else {
+        int si = findSharedVertexSplit(smi);
+        if (si >= 0) {
+            tangents = getTangents();
+            corners = m_topology.split_vertex_corners.data() + m_topology.split_vertex_offsets[si];
+            num = smi.num_vertices;
+        }
+        else {
+            tangents = getTangents() + smi.begin_index;
+            num = smi.num_indices;
+        }
+    }
+
+    aiParallelFor(0, num, aiMinElementsPerTask, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            abcV4 t = tangents[corners ? corners[i] : i];
+            if (reverse_x) {
+                // mirroring flips the handedness too
+                t.x *= -1.0f;
+                t.w *= -1.0f;
+            }
+            dst[i] = t;
+        }
+    });
+}
+
+
+static void aiResizeTextureData(std::vector<abcV4> &data, size_t num)
+{
+    data.resize((num + aiTextureWidth - 1) / aiTextureWidth * aiTextureWidth);
+}
+
+static void aiExpandTextureData(std::vector<abcV4> &data, const abcV3 *src, size_t num, float w, bool reverse_x)
+{
+    aiResizeTextureData(data, num);
+    abcV4 *dst = data.data();
+    aiParallelFor(0, num, aiMinElementsPerTask, [&](size_t b, size_t e) {
+        aiExpandPoints(dst + b, src + b, e - b, w, reverse_x);
+    });
+}
+
+void aiPolyMesh::packTextureData(aiTextureMeshBuffer &buf) const
+{
+    bool reverse_x = m_obj->getReverseX();
+    bool reverse_index = m_obj->getReverseIndex();
+    size_t num_positions = m_positions->size();
+    aiExpandTextureData(buf.vertices, getPositions(), num_positions, 1.0f, reverse_x);
+
+    // normals and uvs are looked up by position index unless their values are per corner, per face or constant
+    bool normal_indexed = false;
+    const int *normal_corners = nullptr;
+    Abc::UInt32ArraySamplePtr normal_indices;
+    if (hasGeneratedNormals()) {
+        aiExpandTextureData(buf.normals, getGeneratedNormals(), num_positions, 0.0f, reverse_x);
+    }
+    else if (m_normals.valid()) {
+        aiExpandTextureData(buf.normals, getNormalValues(), m_normals.getVals()->size(), 0.0f, reverse_x);
+        normal_corners = getCornerNormalIndices();
+        normal_indexed = normal_corners != m_indices->get();
+        normal_indices = m_normals.getIndices();
+    }
+    else {
+        buf.normals.clear();
+    }
+
+    bool uv_indexed = false;
+    const int *uv_corners = nullptr;
+    Abc::UInt32ArraySamplePtr uv_indices;
+    if (m_uvs.valid()) {
+        const auto &uvs = *m_uvs.getVals();
+        size_t num_uvs = uvs.size();
+        aiResizeTextureData(buf.uvs, num_uvs);
+        abcV4 *dst = buf.uvs.data();
+        aiParallelFor(0, num_uvs, aiMinElementsPerTask, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; ++i) {
+                dst[i] = abcV4(uvs[i].x, uvs[i].y, 0.0f, 0.0f);
+            }
+        });
+        uv_corners = getCornerUVIndices();
+        uv_indexed = uv_corners != m_indices->get();
+        uv_indices = m_uvs.getIndices();
+    }
+    else {
+        buf.uvs.clear();
+    }
+
+    if (!buf.valid || buf.reverse_index != reverse_index || buf.face_indices != m_indices || buf.face_counts != m_counts ||
+        buf.is_normal_indexed != normal_indexed || buf.normal_indices != normal_indices ||
+        buf.is_uv_indexed != uv_indexed || buf.uv_indices != uv_indices)
+    {
+        // one texel per corner of the triangulated faces, written in parallel over face ranges
+        const aiTopologyCache &tc = getTopologyCache();
+        const Abc::Int32ArraySample &indices = *m_indices;
+        const int *counts = m_counts->get();
+        int i1 = reverse_index ? 2 : 1;
+        int i2 = reverse_index ? 1 : 2;
+        aiResizeTextureData(buf.indices, tc.triangulated_index_count);
+        abcV4 *dst = buf.indices.data();
+
+        aiParallelFor(0, m_counts->size(), aiMinElementsPerTask, [&](size_t fb, size_t fe) {
+            abcV4 *texel = dst + tc.face_triangle_offsets[fb] * 3;
+            auto corner = [&](int ci) {
+                int pi = std::max<int>(indices[ci], 0);
+                int ni = normal_indexed ? aiCornerValueIndex(normal_corners, ci) : pi;
+                int ui = uv_indexed ? aiCornerValueIndex(uv_corners, ci) : pi;
+                *texel++ = abcV4((float)pi, (float)ni, (float)ui, 0.0f);
+            };
+            for (size_t fi = fb; fi < fe; ++fi) {
+                int a = tc.face_index_offsets[fi];
+                for (int ni = 0; ni < (counts[fi] - 2); ++ni) {
+                    corner(a);
+                    corner(a + i1 + ni);
+                    corner(a + i2 + ni);
+                }
+            }
+        });
+
+        buf.num_indices = tc.triangulated_index_count;
+        buf.reverse_index = reverse_index;
+        buf.face_indices = m_indices;
+        buf.face_counts = m_counts;
+        buf.is_normal_indexed = normal_indexed;
+        buf.normal_indices = normal_indices;
+        buf.is_uv_indexed = uv_indexed;
+        buf.uv_indices = uv_indices;
+    }
+    buf.reverse_x = reverse_x;
+    buf.valid = true;
+}
+
+static void aiUploadTextureData(aiGraphicsDevice *dev, void *texptr, const std::vector<abcV4> &data)
+{
+    if (texptr == nullptr || data.empty()) { return; }
+    dev->copyDataToTexture(texptr, aiTextureWidth, int(data.size() / aiTextureWidth), data.data(), int(sizeof(abcV4) * data.size()));
+}
+
+void aiPolyMesh::copyDataToTexture(aiTextureMeshData &dst)
+{
+    if (m_baked) {
+        dst.num_indices = 0;
+        dst.is_normal_indexed = false;
+        dst.is_uv_indexed = false;
+        return;
+    }
+
+    // updateSample() on the thread pool uses m_texture once it's there, and packing reads the mesh data it writes.
+    // so both are done here only while no update is running
+    aiContext *ctx = m_obj->getContext();
+    if (!m_texture) {
+        ctx->waitTasks();
+        m_texture.reset(new aiTextureMeshBuffers());
+    }
+    aiTextureMeshBuffers &tex = *m_texture;
+    auto swap = [&]() {
+        std::unique_lock<std::mutex> lock(tex.mutex);
+        if (tex.back_ready) {
+            tex.front ^= 1;
+            tex.back_ready = false;
+        }
+    };
+    // nothing packed yet, or the options changed since
+    auto needs_packing = [&]() {
+        const aiTextureMeshBuffer &buf = tex.buffers[tex.front];
+        return !buf.valid || buf.reverse_x != m_obj->getReverseX() || buf.reverse_index != m_obj->getReverseIndex();
+    };
+
+    swap();
+    if (needs_packing()) {
+        ctx->waitTasks();
+        // the update may have packed a newer sample meanwhile
+        swap();
+        if (needs_packing()) {
+            packTextureData(tex.buffers[tex.front]);
+        }
+    }
+    aiTextureMeshBuffer &buf = tex.buffers[tex.front];
+
+    dst.num_indices = buf.num_indices;
+    dst.is_normal_indexed = buf.is_normal_indexed;
+    dst.is_uv_indexed = buf.is_uv_indexed;
+    if (aiGraphicsDevice *dev = aiGetGraphicsDevice()) {
+        aiUploadTextureData(dev, dst.tex_indices, buf.indices);
+        aiUploadTextureData(dev, dst.tex_vertices, buf.vertices);
+        aiUploadTextureData(dev, dst.tex_normals, buf.normals);
+        aiUploadTextureData(dev, dst.tex_uvs, buf.uvs);
+    }
+}
+
+
+static const int aiMeshOutputSlotAttributes[aiMeshOutputSlot_Count] = {
+    aiMeshProperty_Indices,
+    aiMeshProperty_Positions,
+    aiMeshProperty_Normals,
+    aiMeshProperty_UVs,
+    aiMeshProperty_Tangents,
+};
+
+void aiPolyMesh::setOutputBuffer(int split, int attribute, void *dst, int capacity)
+{
+    auto *end = aiMeshOutputSlotAttributes + aiMeshOutputSlot_Count;
+    int slot = int(std::find(aiMeshOutputSlotAttributes, end, attribute) - aiMeshOutputSlotAttributes);
+    if (split < 0 || slot == aiMeshOutputSlot_Count) { return; }
+
+    if ((size_t)split >= m_outputs.size()) {
+        if (dst == nullptr) { return; }
+        m_outputs.resize(split + 1);
+    }
+    aiMeshOutputBuffer &buf = m_outputs[split].slots[slot];
+    buf.data = dst;
+    buf.capacity = dst ? capacity : 0;
+    buf.fresh = dst != nullptr;
+}
+
+void aiPolyMesh::setOutputFormat(int attribute, int format)
+{
+    auto *end = aiMeshOutputSlotAttributes + aiMeshOutputSlot_Count;
+    int slot = int(std::find(aiMeshOutputSlotAttributes, end, attribute) - aiMeshOutputSlotAttributes);
+    if (!aiIsVertexFormatOf(attribute, format) || m_output_formats[slot] == format) { return; }
+
+    // everything already written is in the old format
+    m_output_formats[slot] = format;
+    for (auto &outputs : m_outputs) {
+        outputs.slots[slot].fresh = outputs.slots[slot].data != nullptr;
+    }
+}
+
+// the buffers are written by updateSample(), in the update task of the mesh, and this only hands out what it
+// wrote. they are written here instead if anything that decides their content has changed since: buffers
+// registered or formats set after the update, or other options or max_vertices.
+void aiPolyMesh::writeOutputBuffers(aiMeshOutputResult &o_result, int max_vertices)
+{
+    if (m_output_pending && max_vertices == m_output_max_vertices &&
+        getOutputOptions() == m_output_options && !hasFreshOutputs())
+    {
+        int max_splits = o_result.max_splits;
+        aiMeshSplitCounts *split_counts = o_result.split_counts;
+        o_result = m_output_result;
+        o_result.max_splits = max_splits;
+        o_result.split_counts = split_counts;
+        if (split_counts == nullptr || max_splits < o_result.num_splits) { return; }
+        std::copy(m_output_split_counts.begin(), m_output_split_counts.begin() + o_result.num_splits, split_counts);
+        m_output_pending = false;
+        return;
+    }
+
+    m_output_max_vertices = max_vertices;
+    writeChangedOutputs(o_result, max_vertices);
+    // what the update wrote is still in the buffers that weren't written again
+    if (m_output_pending && o_result.split_counts && o_result.max_splits >= o_result.num_splits) {
+        o_result.dirty_flags |= m_output_result.dirty_flags;
+        if (o_result.num_splits == m_output_result.num_splits) {
+            for (int si = 0; si < o_result.num_splits; ++si) {
+                o_result.split_counts[si].written_flags |= m_output_split_counts[si].written_flags;
+            }
+        }
+        m_output_pending = false;
+    }
+}
+
+// called at the end of updateSample(). nothing is written until the caller has registered buffers and called
+// writeOutputBuffers() once, as max_vertices comes from there
+void aiPolyMesh::writeOutputBuffersAhead()
+{
+    if (m_output_max_vertices <= 0 || m_outputs.empty()) { return; }
+
+    // a result nobody took keeps telling what was written, as the buffers still hold it
+    bool merge = m_output_pending;
+    int prev_dirty_flags = m_output_result.dirty_flags;
+    std::vector<aiMeshSplitCounts> prev_counts;
+    if (merge) { prev_counts.assign(m_output_split_counts.begin(), m_output_split_counts.begin() + m_output_result.num_splits); }
+
+    aiMeshOutputResult &result = m_output_result;
+    result.max_splits = (int)m_output_split_counts.size();
+    result.split_counts = m_output_split_counts.data();
+    writeChangedOutputs(result, m_output_max_vertices);
+    if (result.num_splits > result.max_splits) {
+        m_output_split_counts.resize(result.num_splits);
+        result.max_splits = result.num_splits;
+        result.split_counts = m_output_split_counts.data();
+        writeChangedOutputs(result, m_output_max_vertices);
+    }
+
+    if (merge) {
+        result.dirty_flags |= prev_dirty_flags;
+        if ((size_t)result.num_splits == prev_counts.size()) {
+            for (int si = 0; si < result.num_splits; ++si) {
+                result.split_counts[si].written_flags |= prev_counts[si].written_flags;
+            }
+        }
+    }
+    m_output_pending = true;
+}
+
+bool aiPolyMesh::hasFreshOutputs() const
+{
+    const bool available[aiMeshOutputSlot_Count] = { true, true, hasNormals(), hasUVs(), hasTangents() };
+    for (const auto &outputs : m_outputs) {
+        for (int slot = 0; slot < aiMeshOutputSlot_Count; ++slot) {
+            const aiMeshOutputBuffer &buf = outputs.slots[slot];
+            if (buf.data != nullptr && buf.fresh && available[slot]) { return true; }
+        }
+    }
+    return false;
+}
+
+// object options that change what is written
+int aiPolyMesh::getOutputOptions() const
+{
+    return (m_obj->getReverseX() ? 1 : 0) | (m_obj->getReverseIndex() ? 2 : 0) | (m_obj->getTriangulate() ? 4 : 0) |
+        (m_obj->getShareVertices() ? 8 : 0) | (m_obj->getGenerateNormals() ? 16 : 0) | (m_obj->getGenerateTangents() ? 32 : 0);
+}
+
+// writes the registered buffers of every split that are new or whose attribute changed. a topology change
+// rewrites all of them, as split vertices are made from the topology
+void aiPolyMesh::writeChangedOutputs(aiMeshOutputResult &o_result, int max_vertices)
+{
+    // everything already written is made with the old options
+    int options = getOutputOptions();
+    if (options != m_output_options) {
+        m_output_options = options;
+        for (auto &outputs : m_outputs) {
+            for (auto &buf : outputs.slots) { buf.fresh = buf.data != nullptr; }
+        }
+    }
+    o_result.dirty_flags = m_dirty_flags;
+    o_result.num_splits = 0;
+    o_result.num_too_small = 0;
+    if (m_output_formats[aiMeshOutputSlot_Positions] == aiVertexFormat_UNorm16x4 ||
+        m_output_formats[aiMeshOutputSlot_UVs] == aiVertexFormat_UNorm16x2)
+    {
+        o_result.quantization = getQuantizationParams();
+    }
+    else {
+        o_result.quantization = aiQuantizationParams();
+    }
+
+    bool topology_changed = (m_dirty_flags & aiMeshProperty_Topology) != 0;
+    const bool available[aiMeshOutputSlot_Count] = { true, true, hasNormals(), hasUVs(), hasTangents() };
+
+    // builds the splits. baked ones are there already
+    const aiSplitedMeshInfo *splits = nullptr;
+    if (m_baked) {
+        if (m_baked_frame) {
+            splits = m_baked->get<aiSplitedMeshInfo>(m_baked_frame->splits);
+            o_result.num_splits = (int)m_baked_frame->num_splits;
+        }
+    }
+    else {
+        aiSplitedMeshInfo first = {}, none = {};
+        getSplitedMeshInfo(first, none, max_vertices);
+        const auto &tc_splits = getTopologyCache().splits;
+        splits = tc_splits.data();
+        o_result.num_splits = (int)tc_splits.size();
+    }
+    if (o_result.split_counts == nullptr || o_result.max_splits < o_result.num_splits) { return; }
+
+    for (int si = 0; si < o_result.num_splits; ++si) {
+        const aiSplitedMeshInfo &smi = splits[si];
+        aiMeshSplitCounts counts = { smi.triangulated_index_count, smi.num_vertices, 0 };
+        for (int slot = 0; (size_t)si < m_outputs.size() && slot < aiMeshOutputSlot_Count; ++slot) {
+            aiMeshOutputBuffer &buf = m_outputs[si].slots[slot];
+            int attribute = aiMeshOutputSlotAttributes[slot];
+            if (buf.data == nullptr || !available[slot]) { continue; }
+            if (!buf.fresh && !topology_changed && (m_dirty_flags & attribute) == 0) { continue; }
+
+            int needed = slot == aiMeshOutputSlot_Indices ? counts.index_count : counts.vertex_count;
+            if (buf.capacity < needed) {
+                ++o_result.num_too_small;
+                continue;
+            }
+            switch (slot) {
+            case aiMeshOutputSlot_Indices:  copySplitedIndices((int*)buf.data, smi); break;
+            case aiMeshOutputSlot_Tangents: copySplitedTangents((abcV4*)buf.data, smi); break;
+            default: copySplitedAttribute(buf.data, smi, attribute, m_output_formats[slot]); break;
+            }
+            buf.fresh = false;
+            counts.written_flags |= attribute;
+        }
+        o_result.split_counts[si] = counts;
+    }
+}
+
+
+aiCurves::aiCurves()
+    : m_basis_index(-1), m_periodic(false), m_dirty_flags(0), m_topology_dirty(true), m_split_max_vertices(0)
+{}
 
-aiCurves::aiCurves() {}
-
 aiCurves::aiCurves(aiObject *obj)
-    : super(obj)
+    : super(obj), m_basis_index(-1), m_periodic(false), m_dirty_flags(0), m_topology_dirty(true), m_split_max_vertices(0)
 {
     AbcGeom::ICurves curves(obj->getAbcObject(), Abc::kWrapExisting);
     m_schema = curves.getSchema();
+    if (m_schema.getPropertyHeader("curveBasisAndType")) {
+        m_basis_and_type = Abc::IScalarProperty(m_schema, "curveBasisAndType");
+    }
 }
 
 void aiCurves::updateSample()
 {
     Abc::ISampleSelector ss(m_obj->getCurrentTime());
-    // todo
+    m_dirty_flags = 0;
+
+    if (aiSampleChanged(m_schema.getNumVerticesProperty(), ss, m_counts_state)) {
+        m_schema.getNumVerticesProperty().get(m_counts, ss);
+        m_dirty_flags |= aiCurvesProperty_Counts;
+    }
+    // type, wrap and basis, in this order. only the wrap matters to line lists
+    if (m_basis_and_type.valid()) {
+        Abc::index_t index = ss.getIndex(m_basis_and_type.getTimeSampling(), m_basis_and_type.getNumSamples());
+        if (index != m_basis_index) {
+            m_basis_index = index;
+            uint8_t basis_and_type[4] = {};
+            m_basis_and_type.get(basis_and_type, Abc::ISampleSelector(index));
+            bool periodic = basis_and_type[1] == AbcGeom::kPeriodic;
+            if (periodic != m_periodic) {
+                m_periodic = periodic;
+                m_dirty_flags |= aiCurvesProperty_Counts;
+            }
+        }
+    }
+    if (aiSampleChanged(m_schema.getPositionsProperty(), ss, m_positions_state)) {
+        m_schema.getPositionsProperty().get(m_positions, ss);
+        m_dirty_flags |= aiCurvesProperty_Positions;
+    }
+    if (m_schema.getWidthsParam().valid()) {
+        if (aiGeomParamSampleChanged(m_schema.getWidthsParam(), ss, m_widths_state, m_width_indices_state)) {
+            m_schema.getWidthsParam().getExpanded(m_widths, ss);
+            m_dirty_flags |= aiCurvesProperty_Widths;
+        }
+    }
+    if (m_dirty_flags & aiCurvesProperty_Counts) {
+        m_topology_dirty = true;
+    }
+}
+
+int aiCurves::getDirtyFlags() const
+{
+    return m_dirty_flags;
+}
+
+int aiCurves::getNumCurves() const
+{
+    return m_counts ? (int)m_counts->size() : 0;
+}
+
+int aiCurves::getVertexCount() const
+{
+    return m_positions ? (int)m_positions->size() : 0;
+}
+
+bool aiCurves::hasWidths() const
+{
+    size_t num = m_widths.getVals() ? m_widths.getVals()->size() : 0;
+    return num > 0 && (num == 1 || num == (size_t)getNumCurves() || num == (size_t)getVertexCount());
+}
+
+void aiCurves::updateTopology() const
+{
+    if (!m_topology_dirty) { return; }
+    m_topology_dirty = false;
+    m_split_max_vertices = 0;
+
+    size_t num_curves = getNumCurves();
+    m_offsets.resize(num_curves + 1);
+    m_offsets[0] = 0;
+    for (size_t ci = 0; ci < num_curves; ++ci) {
+        m_offsets[ci + 1] = m_offsets[ci] + std::max<int>((*m_counts)[ci], 0);
+    }
+}
+
+static int aiCountCurveIndices(int num_vertices, bool periodic)
+{
+    if (num_vertices < 2) { return 0; }
+    return (periodic && num_vertices > 2 ? num_vertices : num_vertices - 1) * 2;
+}
+
+// line list of the curves [cb, ce) of the split, each written at its own offset in dst
+static void aiWriteCurveIndices(int *dst, const int *index_offsets, const int *offsets, size_t cb, size_t ce, int begin_vertex, bool periodic)
+{
+    for (size_t ci = cb; ci < ce; ++ci) {
+        int first = offsets[ci] - begin_vertex;
+        int n = offsets[ci + 1] - offsets[ci];
+        int num_segments = aiCountCurveIndices(n, periodic) / 2;
+        int *d = dst + index_offsets[ci];
+        for (int i = 0; i < num_segments; ++i) {
+            d[i * 2 + 0] = first + i;
+            d[i * 2 + 1] = first + (i + 1) % n;
+        }
+    }
+}
+
+// splits are made curve by curve, then the line lists of the curves of each split are written concurrently
+void aiCurves::buildSplits(int max_vertices) const
+{
+    m_split_max_vertices = max_vertices;
+    m_splits.clear();
+    m_indices.clear();
+
+    size_t num_curves = getNumCurves();
+    if (num_curves == 0 || m_offsets[num_curves] > getVertexCount()) { return; }
+
+    std::vector<int> index_offsets(num_curves + 1);
+    aiCurvesSplitInfo split = {};
+    for (size_t ci = 0; ci < num_curves; ++ci) {
+        int n = m_offsets[ci + 1] - m_offsets[ci];
+        int ni = aiCountCurveIndices(n, m_periodic);
+        if (split.num_curves > 0 && split.num_vertices + n > max_vertices) {
+            m_splits.push_back(split);
+            split.begin_curve = (int)ci;
+            split.begin_vertex = m_offsets[ci];
+            split.begin_index += split.num_indices;
+            split.num_curves = split.num_vertices = split.num_indices = 0;
+        }
+        index_offsets[ci] = split.begin_index + split.num_indices;
+        split.num_curves += 1;
+        split.num_vertices += n;
+        split.num_indices += ni;
+    }
+    m_splits.push_back(split);
+    index_offsets[num_curves] = split.begin_index + split.num_indices;
+
+    m_indices.resize(index_offsets[num_curves]);
+    for (const aiCurvesSplitInfo &s : m_splits) {
+        aiParallelFor(s.begin_curve, s.begin_curve + s.num_curves, aiMinElementsPerTask / 4, [&](size_t cb, size_t ce) {
+            aiWriteCurveIndices(m_indices.data(), index_offsets.data(), m_offsets.data(), cb, ce, s.begin_vertex, m_periodic);
+        });
+    }
+}
+
+int aiCurves::getSplits(aiCurvesSplitInfo *dst, int max_splits, int max_vertices) const
+{
+    if (max_vertices <= 0) { return 0; }
+    updateTopology();
+    if (max_vertices != m_split_max_vertices) {
+        buildSplits(max_vertices);
+    }
+    int num = (int)m_splits.size();
+    if (dst) {
+        std::copy(m_splits.begin(), m_splits.begin() + std::min(num, std::max(max_splits, 0)), dst);
+    }
+    return num;
+}
+
+void aiCurves::copySplitData(aiCurvesData &dst, const aiCurvesSplitInfo &split) const
+{
+    updateTopology();
+    int num_curves = getNumCurves();
+    // a split of other vertex counts than the current ones is refused
+    if (split.begin_curve < 0 || split.num_curves < 0 || split.begin_curve + split.num_curves > num_curves) { return; }
+    int bc = split.begin_curve, ec = split.begin_curve + split.num_curves;
+    if (m_offsets[ec] > getVertexCount() ||
+        m_offsets[bc] != split.begin_vertex || m_offsets[ec] - m_offsets[bc] != split.num_vertices) { return; }
+
+    if (dst.positions && m_positions) {
+        aiParallelCopyPoints(dst.positions, m_positions->get() + split.begin_vertex, split.num_vertices, m_obj->getReverseX());
+    }
+    if (dst.widths) {
+        const float *widths = hasWidths() ? m_widths.getVals()->get() : nullptr;
+        size_t num_widths = widths ? m_widths.getVals()->size() : 0;
+        if (!widths) {
+            memset(dst.widths, 0, sizeof(float) * split.num_vertices);
+        }
+        else if (num_widths == (size_t)getVertexCount()) {
+            aiParallelCopy(dst.widths, widths + split.begin_vertex, split.num_vertices);
+        }
+        else if (num_widths == (size_t)num_curves) {
+            aiParallelFor(bc, ec, aiMinElementsPerTask / 4, [&](size_t cb, size_t ce) {
+                for (size_t ci = cb; ci < ce; ++ci) {
+                    std::fill(dst.widths + (m_offsets[ci] - split.begin_vertex), dst.widths + (m_offsets[ci + 1] - split.begin_vertex), widths[ci]);
+                }
+            });
+        }
+        else {
+            std::fill_n(dst.widths, split.num_vertices, widths[0]);
+        }
+    }
+    if (dst.indices) {
+        // copied from the line lists made by getSplits(). a split made by the caller is written from scratch
+        auto it = std::lower_bound(m_splits.begin(), m_splits.end(), split.begin_curve,
+            [](const aiCurvesSplitInfo &s, int c) { return s.begin_curve < c; });
+        if (m_split_max_vertices != 0 && it != m_splits.end() &&
+            it->begin_curve == split.begin_curve && it->num_curves == split.num_curves)
+        {
+            aiParallelCopy(dst.indices, m_indices.data() + it->begin_index, std::min(it->num_indices, split.num_indices));
+        }
+        else {
+            std::vector<int> index_offsets(ec + 1);
+            int num_indices = 0;
+            for (int ci = bc; ci < ec; ++ci) {
+                index_offsets[ci] = num_indices;
+                num_indices += aiCountCurveIndices(m_offsets[ci + 1] - m_offsets[ci], m_periodic);
+            }
+            if (num_indices <= split.num_indices) {
+                aiParallelFor(bc, ec, aiMinElementsPerTask / 4, [&](size_t cb, size_t ce) {
+                    aiWriteCurveIndices(dst.indices, index_offsets.data(), m_offsets.data(), cb, ce, split.begin_vertex, m_periodic);
+                });
+            }
+        }
+    }
+    if (dst.curve_offsets || dst.curve_counts) {
+        aiParallelFor(bc, ec, aiMinElementsPerTask, [&](size_t cb, size_t ce) {
+            for (size_t ci = cb; ci < ce; ++ci) {
+                if (dst.curve_offsets) { dst.curve_offsets[ci - bc] = m_offsets[ci] - split.begin_vertex; }
+                if (dst.curve_counts)  { dst.curve_counts[ci - bc] = m_offsets[ci + 1] - m_offsets[ci]; }
+            }
+        });
+    }
 }
 
 
 
-aiPoints::aiPoints() {}
+aiPoints::aiPoints()
+    : m_dirty_flags(0), m_sort(false), m_order_dirty(true)
+{}
 
 aiPoints::aiPoints(aiObject *obj)
-    : super(obj)
+    : super(obj), m_dirty_flags(0), m_sort(false), m_order_dirty(true)
 {
     AbcGeom::IPoints points(obj->getAbcObject(), Abc::kWrapExisting);
     m_schema = points.getSchema();
@@ -380,33 +2352,233 @@ aiPoints::aiPoints(aiObject *obj)
 void aiPoints::updateSample()
 {
     Abc::ISampleSelector ss(m_obj->getCurrentTime());
-    // todo
+    m_dirty_flags = 0;
+
+    if (aiSampleChanged(m_schema.getPositionsProperty(), ss, m_positions_state)) {
+        m_schema.getPositionsProperty().get(m_positions, ss);
+        m_dirty_flags |= aiPointsProperty_Positions;
+    }
+    if (m_schema.getVelocitiesProperty().valid()) {
+        if (aiSampleChanged(m_schema.getVelocitiesProperty(), ss, m_velocities_state)) {
+            m_schema.getVelocitiesProperty().get(m_velocities, ss);
+            m_dirty_flags |= aiPointsProperty_Velocities;
+        }
+    }
+    if (m_schema.getIdsProperty().valid() && aiSampleChanged(m_schema.getIdsProperty(), ss, m_ids_state)) {
+        m_schema.getIdsProperty().get(m_ids, ss);
+        m_dirty_flags |= aiPointsProperty_IDs;
+    }
+    if (m_dirty_flags & (aiPointsProperty_Positions | aiPointsProperty_IDs)) {
+        m_order_dirty = true;
+    }
+}
+
+void aiPoints::enableSort(bool v)
+{
+    if (v != m_sort) {
+        m_sort = v;
+        m_order_dirty = true;
+    }
+}
+
+int aiPoints::getDirtyFlags() const
+{
+    return m_dirty_flags;
+}
+
+int aiPoints::getCount() const
+{
+    return m_positions ? (int)m_positions->size() : 0;
+}
+
+bool aiPoints::hasVelocities() const
+{
+    return m_velocities && m_positions && m_velocities->size() == m_positions->size();
+}
+
+bool aiPoints::hasIDs() const
+{
+    return m_ids && m_positions && m_ids->size() == m_positions->size();
+}
+
+// stable LSD radix sort of the sample indices by id, so equal ids stay in sample order. 11 bit digits, skipping the
+// digits that are the same in every id: ids below 2^32 take 3 passes. each pass counts and scatters chunks of the
+// points concurrently, every chunk writing to its own range of each bucket
+static void aiSortByID(std::vector<int> &order, const uint64_t *ids, size_t num)
+{
+    const int digit_bits = 11;
+    const size_t num_buckets = size_t(1) << digit_bits;
+    const uint64_t digit_mask = num_buckets - 1;
+
+    uint64_t varying = 0;
+    for (size_t i = 0; i < num; ++i) { varying |= ids[i] ^ ids[0]; }
+
+    std::vector<uint64_t> keys(ids, ids + num), keys_tmp(num);
+    std::vector<int> order_tmp(num);
+    order.resize(num);
+    for (size_t i = 0; i < num; ++i) { order[i] = (int)i; }
+
+    size_t num_chunks = std::min<size_t>(aiGetNumTaskThreads(), std::max<size_t>(num / aiMinElementsPerTask, 1));
+    size_t chunk = (num + num_chunks - 1) / num_chunks;
+    std::vector<size_t> offsets(num_chunks * num_buckets);
+    for (int shift = 0; shift < 64; shift += digit_bits) {
+        if (((varying >> shift) & digit_mask) == 0) { continue; }
+
+        aiParallelFor(0, num_chunks, 1, [&](size_t b, size_t e) {
+            for (size_t c = b; c < e; ++c) {
+                size_t *counts = &offsets[c * num_buckets];
+                std::fill_n(counts, num_buckets, 0);
+                for (size_t i = c * chunk, end = std::min(i + chunk, num); i < end; ++i) {
+                    ++counts[(keys[i] >> shift) & digit_mask];
+                }
+            }
+        });
+        // bucket by bucket, chunk by chunk
+        size_t sum = 0;
+        for (size_t bucket = 0; bucket < num_buckets; ++bucket) {
+            for (size_t c = 0; c < num_chunks; ++c) {
+                size_t n = offsets[c * num_buckets + bucket];
+                offsets[c * num_buckets + bucket] = sum;
+                sum += n;
+            }
+        }
+        aiParallelFor(0, num_chunks, 1, [&](size_t b, size_t e) {
+            for (size_t c = b; c < e; ++c) {
+                size_t *dst = &offsets[c * num_buckets];
+                for (size_t i = c * chunk, end = std::min(i + chunk, num); i < end; ++i) {
+                    size_t o = dst[(keys[i] >> shift) & digit_mask]++;
+                    keys_tmp[o] = keys[i];
+                    order_tmp[o] = order[i];
+                }
+            }
+        });
+        keys.swap(keys_tmp);
+        order.swap(order_tmp);
+    }
+}
+
+// null if sorting is off or the points are in id order already, which is common as particles are usually stored
+// in the order they were born
+const int* aiPoints::getOrder() const
+{
+    if (!m_sort || !hasIDs()) { return nullptr; }
+    if (m_order_dirty) {
+        m_order_dirty = false;
+        m_order.clear();
+        const uint64_t *ids = m_ids->get();
+        size_t num = m_ids->size();
+        std::atomic<bool> sorted(true);
+        aiParallelFor(1, num, aiMinElementsPerTask, [&](size_t b, size_t e) {
+            for (size_t i = b; i < e && sorted; ++i) {
+                if (ids[i - 1] > ids[i]) { sorted = false; }
+            }
+        });
+        if (!sorted) { aiSortByID(m_order, ids, num); }
+    }
+    return m_order.empty() ? nullptr : m_order.data();
+}
+
+bool aiPoints::copyData(aiPointsData &dst) const
+{
+    int num = getCount();
+    dst.num_points = num;
+    if (dst.capacity < num) { return false; }
+
+    bool reverse_x = m_obj->getReverseX();
+    const int *order = getOrder();
+    const abcV3 *positions = num > 0 ? m_positions->get() : nullptr;
+    const abcV3 *velocities = hasVelocities() ? m_velocities->get() : nullptr;
+    const uint64_t *ids = hasIDs() ? m_ids->get() : nullptr;
+    // each task does all arrays of its range
+    aiParallelFor(0, num, aiMinElementsPerTask, [&](size_t b, size_t e) {
+        size_t n = e - b;
+        if (dst.positions) {
+            if (order) { aiGatherPoints(dst.positions + b, positions, order + b, n, reverse_x); }
+            else       { aiCopyPoints(dst.positions + b, positions + b, n, reverse_x); }
+        }
+        if (dst.velocities) {
+            if (!velocities) { std::fill_n(dst.velocities + b, n, abcV3(0.0f)); }
+            else if (order)  { aiGatherPoints(dst.velocities + b, velocities, order + b, n, reverse_x); }
+            else             { aiCopyPoints(dst.velocities + b, velocities + b, n, reverse_x); }
+        }
+        if (dst.ids) {
+            if (!ids) {
+                for (size_t i = b; i < e; ++i) { dst.ids[i] = i; }
+            }
+            else if (order) {
+                for (size_t i = b; i < e; ++i) { dst.ids[i] = ids[order[i]]; }
+            }
+            else {
+                memcpy(dst.ids + b, ids + b, sizeof(uint64_t) * n);
+            }
+        }
+    });
+    return true;
 }
 
 
 
-aiCamera::aiCamera() {}
+aiCamera::aiCamera()
+    : m_sample_index(-1)
+{
+    toParams(AbcGeom::CameraSample(), m_params);
+}
 
 aiCamera::aiCamera(aiObject *obj)
-    : super(obj)
+    : super(obj), m_sample_index(-1)
 {
     AbcGeom::ICamera cam(obj->getAbcObject(), Abc::kWrapExisting);
     m_schema = cam.getSchema();
+    toParams(AbcGeom::CameraSample(), m_params);
+}
+
+void aiCamera::toParams(const AbcGeom::CameraSample &sample, aiCameraParams &o_params)
+{
+    o_params.near_clipping_plane = (float)sample.getNearClippingPlane();
+    o_params.far_clipping_plane = (float)sample.getFarClippingPlane();
+    o_params.field_of_view = (float)sample.getFieldOfView();
+    o_params.focus_distance = (float)sample.getFocusDistance() * 0.1f; // centimeter to meter
+    o_params.focal_length = (float)sample.getFocalLength() * 0.01f; // milimeter to meter
+}
+
+void aiCamera::preloadTrack()
+{
+    size_t num_samples = m_schema.getNumSamples();
+    if (num_samples == 0) { return; }
+
+    aiTrack<aiCameraParams> track;
+    track.times = m_obj->getContext()->getTrackTimes(m_schema.getTimeSampling(), num_samples);
+    track.samples.resize(num_samples);
+    AbcGeom::CameraSample sample;
+    for (size_t i = 0; i < num_samples; ++i) {
+        m_schema.get(sample, Abc::ISampleSelector((Abc::index_t)i));
+        toParams(sample, track.samples[i]);
+    }
+    m_track = std::move(track);
 }
 
 void aiCamera::updateSample()
 {
-    Abc::ISampleSelector ss(m_obj->getCurrentTime());
-    // todo
+    float time = m_obj->getCurrentTime();
+    if (m_track.valid()) {
+        m_params = m_track.getNear(time);
+        return;
+    }
+
+    size_t num_samples = m_schema.getNumSamples();
+    if (num_samples == 0) { return; }
+    Abc::index_t index = Abc::ISampleSelector(time).getIndex(m_schema.getTimeSampling(), num_samples);
+    if (index != m_sample_index) {
+        AbcGeom::CameraSample sample;
+        m_schema.get(sample, Abc::ISampleSelector(index));
+        toParams(sample, m_params);
+        m_sample_index = index;
+    }
 }
 
 void aiCamera::getParams(aiCameraParams &o_params)
 {
-    o_params.near_clipping_plane = m_sample.getNearClippingPlane();
-    o_params.far_clipping_plane = m_sample.getFarClippingPlane();
-    o_params.field_of_view = m_sample.getFieldOfView();
-    o_params.focus_distance = m_sample.getFocusDistance() * 0.1f; // centimeter to meter
-    o_params.focal_length = m_sample.getFocalLength() * 0.01f; // milimeter to meter
+    o_params = m_params;
 }
 
 
@@ -1,6 +1,157 @@
 ﻿#ifndef aiGeometry_h
 #define aiGeometry_h
 
+#include "aiTracks.h"
+
+class aiBakedCache;
+struct aiBakedMeshFrame;
+class aiDeltaCache;
+
+// remembers which sample of a property is currently held, so that the same data is not read again
+struct aiSampleState
+{
+    aiSampleState() : index(-1), key(), has_key(false) {}
+    Abc::index_t index;
+    AbcCoreAbstract::ArraySampleKey key;
+    bool has_key;
+};
+
+
+// all array data of one aiPolyMesh sample
+struct aiPolyMeshSample
+{
+    aiPolyMeshSample() : index(-1) {}
+    size_t getSizeInBytes() const;
+
+    Abc::index_t index;
+    Abc::Int32ArraySamplePtr indices;
+    Abc::Int32ArraySamplePtr counts;
+    Abc::P3fArraySamplePtr positions;
+    Abc::V3fArraySamplePtr velocities;
+    AbcGeom::IN3fGeomParam::Sample normals;
+    AbcGeom::IV2fGeomParam::Sample uvs;
+};
+typedef std::shared_ptr<aiPolyMeshSample> aiPolyMeshSamplePtr;
+
+
+// which value of a geom param each face corner refers to, when the indices it is looked up by can't be used as they
+// are. see aiGetCornerValueIndices()
+struct aiCornerValueIndices
+{
+    aiCornerValueIndices() : num_values(0), valid(false) {}
+
+    aiSampleState indices;      // of an indexed geom param, and the number of values it was made for
+    size_t num_values;
+    bool valid;
+    std::vector<int> table;     // empty if they can
+};
+
+// everything derived from the mesh topology alone. kept until indices, counts or the options it depends on
+// change, so meshes with constant topology build it only once.
+struct aiTopologyCache
+{
+    aiTopologyCache() : reverse_index(false), share_vertices(false), max_vertices(0), triangulated_index_count(0), last_split(0) {}
+
+    // what the cache was built from
+    Abc::Int32ArraySamplePtr indices;
+    Abc::Int32ArraySamplePtr counts;
+    aiSampleState normal_indices;               // these two only matter when share_vertices
+    aiSampleState uv_indices;
+    bool reverse_index;
+    bool share_vertices;
+    int max_vertices;
+
+    uint32_t triangulated_index_count;
+    std::vector<int> face_index_offsets;        // exclusive prefix sum of counts. num faces + 1 elements
+    std::vector<int> face_triangle_offsets;     // same for the number of triangles of each face
+    std::vector<int> vertex_corner_offsets;     // offset of each position in vertex_corners. for generated normals
+    std::vector<int> vertex_corners;            // face corners that refer to each position
+    std::vector<int> triangulated_indices;      // copyIndices(). built on first use
+    aiCornerValueIndices normal_values;         // getCornerNormalIndices(). built on first use
+    aiCornerValueIndices uv_values;             // getCornerUVIndices()
+    std::vector<aiSplitedMeshInfo> splits;      // getSplitedMeshInfo(). built on first use
+    std::vector<int> split_index_offsets;       // offset of each split in split_indices
+    std::vector<int> split_indices;             // copySplitedIndices()
+    // remap tables of shared vertices: index into positions, normals and uvs of each vertex of each split.
+    // split_vertex_offsets is the offset of each split in them. share_vertices only
+    std::vector<int> split_vertex_offsets;
+    std::vector<int> split_vertex_positions;
+    std::vector<int> split_vertex_normals;
+    std::vector<int> split_vertex_uvs;
+    std::vector<int> split_vertex_corners;      // first face corner of each vertex. for per-corner data like tangents
+    size_t last_split;
+};
+
+
+// float4 texels of aiPolyMesh::copyDataToTexture(), laid out as described at aiTextureMeshData.
+// each array is padded to whole rows of aiTextureWidth
+struct aiTextureMeshBuffer
+{
+    aiTextureMeshBuffer() : num_indices(0), is_normal_indexed(false), is_uv_indexed(false), valid(false), reverse_x(false), reverse_index(false) {}
+
+    std::vector<abcV4> indices;
+    std::vector<abcV4> vertices;
+    std::vector<abcV4> normals;
+    std::vector<abcV4> uvs;
+    int num_indices;
+    bool is_normal_indexed;
+    bool is_uv_indexed;
+
+    // what it was packed from. indices are only packed again when these change
+    bool valid;
+    bool reverse_x;
+    bool reverse_index;
+    Abc::Int32ArraySamplePtr face_indices;
+    Abc::Int32ArraySamplePtr face_counts;
+    Abc::UInt32ArraySamplePtr normal_indices;
+    Abc::UInt32ArraySamplePtr uv_indices;
+};
+
+// double buffered: once texture output is in use, updateSample() packs the back buffer on the worker thread
+// while the front one may still be being uploaded. copyDataToTexture() flips them when the back one is ready.
+struct aiTextureMeshBuffers
+{
+    aiTextureMeshBuffers() : front(0), back_ready(false) {}
+
+    aiTextureMeshBuffer buffers[2];
+    int front;
+    bool back_ready;
+    std::mutex mutex;
+};
+
+
+// where the values of an attribute of a split come from: values[indices[i]], or values[i] if indices is null
+template<class T>
+struct aiSplitSource
+{
+    const T *values;
+    const int *indices;
+    size_t num;
+};
+
+
+// caller owned destinations of the attributes of one split. see aiPolyMeshSetOutputBuffer()
+struct aiMeshOutputBuffer
+{
+    aiMeshOutputBuffer() : data(nullptr), capacity(0), fresh(false) {}
+    void *data;
+    int capacity;
+    bool fresh;     // registered since the last write
+};
+enum aiMeshOutputSlot
+{
+    aiMeshOutputSlot_Indices,
+    aiMeshOutputSlot_Positions,
+    aiMeshOutputSlot_Normals,
+    aiMeshOutputSlot_UVs,
+    aiMeshOutputSlot_Tangents,
+    aiMeshOutputSlot_Count,
+};
+struct aiMeshOutputBuffers
+{
+    aiMeshOutputBuffer slots[aiMeshOutputSlot_Count];
+};
+
 
 class aiSchema
 {
@@ -9,6 +160,7 @@ public:
     aiSchema(aiObject *obj);
     virtual ~aiSchema();
     virtual void updateSample() = 0;
+    aiObject* getObject() const { return m_obj; }
 
 protected:
     aiObject *m_obj;
@@ -21,8 +173,13 @@ typedef aiSchema super;
 public:
     aiXForm();
     aiXForm(aiObject *obj);
+    // plays the xform'th local matrix of the frames of a baked cache
+    aiXForm(aiObject *obj, const aiBakedCache *cache, int xform);
     void updateSample() override;
+    // reads the matrices of all samples, which updateSample() then only looks up
+    void preloadTrack();
 
+    bool        isDirty() const;
     bool        getInherits() const;
     abcV3       getPosition() const;
     abcV3       getAxis() const;
@@ -31,9 +188,29 @@ public:
     abcM44      getMatrix() const;
 
 private:
+    void        updateBakedSample();
+    void        readSample(Abc::index_t index, Abc::M44d &o_matrix, bool &o_inherits);
+
+private:
+    struct TrackSample
+    {
+        abcM44 matrix;
+        bool inherits;
+    };
+
     AbcGeom::IXformSchema m_schema;
-    AbcGeom::XformSample m_sample;
+    aiTrack<TrackSample> m_track;           // instead of reading m_schema, if preloaded
+    Abc::M44d m_matrix;                     // at the current time. a blend of the two below with aiSubframeMode_Linear
+    Abc::M44d m_floor_matrix;
+    Abc::M44d m_next_matrix;
+    Abc::index_t m_sample_index;
+    Abc::index_t m_next_index;
+    float m_blend;
     bool m_inherits;
+    bool m_next_inherits;
+    bool m_dirty;
+    const aiBakedCache *m_baked; // instead of m_schema, if not null
+    int m_baked_index;
 };
 
 
@@ -43,6 +220,9 @@ typedef aiSchema super;
 public:
     aiPolyMesh();
     aiPolyMesh(aiObject *obj);
+    // plays the mesh'th mesh of a baked cache. only the split data is there: the unsplit getters are empty,
+    // splits are the baked ones whatever max_vertices is asked for, and textures are not supported
+    aiPolyMesh(aiObject *obj, const aiBakedCache *cache, int mesh);
     void updateSample() override;
 
     void        setCurrentTime(float t);
@@ -54,6 +234,15 @@ public:
     bool        isTopologyConstantTriangles() const;
     bool        hasNormals() const;
     bool        hasUVs() const;
+    bool        hasTangents() const;
+    int         getDirtyFlags() const; // combination of aiMeshProperty flags changed by the last updateSample()
+
+    size_t      getNumSamples() const;
+    Abc::index_t getSampleIndex(float time) const;
+    // reads all properties of the sample. can be called from any thread (used by aiPrefetcher)
+    aiPolyMeshSamplePtr readSample(Abc::index_t index) const;
+    // decoded from the delta cache of the context if it has the mesh, read from the archive otherwise
+    Abc::P3fArraySamplePtr readPositions(Abc::index_t index) const;
 
     uint32_t    getIndexCount() const;
     uint32_t    getVertexCount() const;
@@ -67,6 +256,48 @@ public:
     void        copySplitedVertices(abcV3 *dst, const aiSplitedMeshInfo &smi) const;
     void        copySplitedNormals(abcV3 *dst, const aiSplitedMeshInfo &smi) const;
     void        copySplitedUVs(abcV2 *dst, const aiSplitedMeshInfo &smi) const;
+    void        copySplitedTangents(abcV4 *dst, const aiSplitedMeshInfo &smi) const;
+    // positions, normals or uvs in any aiVertexFormat
+    void        copySplitedAttribute(void *dst, const aiSplitedMeshInfo &smi, int attribute, int format) const;
+    const aiQuantizationParams& getQuantizationParams() const;
+
+    // uploads through aiGetGraphicsDevice() to the textures in dst that are not null, and fills in the rest of dst.
+    // from the first call on, updateSample() packs the texture data of each new sample
+    void        copyDataToTexture(aiTextureMeshData &dst);
+
+    void        setOutputBuffer(int split, int attribute, void *dst, int capacity);
+    void        setOutputFormat(int attribute, int format);
+    void        writeOutputBuffers(aiMeshOutputResult &o_result, int max_vertices);
+
+private:
+    void        updateBakedSample();
+    int         findBakedSplit(const aiSplitedMeshInfo &smi) const;
+    aiTopologyCache& getTopologyCache() const;
+    void        buildSplits(aiTopologyCache &tc, int max_vertices) const;
+    int         findSplit(const aiSplitedMeshInfo &smi) const;
+    int         findSharedVertexSplit(const aiSplitedMeshInfo &smi) const;
+    // index into normal or uv values of each face corner, in range. null if it's the face corner itself
+    const int*  getCornerNormalIndices() const;
+    const int*  getCornerUVIndices() const;
+    bool        hasGeneratedNormals() const;
+    bool        useVelocities() const;
+    bool        useInterpolation() const;
+    Abc::ISampleSelector::TimeIndexType getTimeIndexType() const;
+    void        updateSubframeData(float time);
+    const abcV3* getPositions() const;
+    const abcV3* getNormalValues() const;
+    const abcV3* getGeneratedNormals() const;
+    bool        updateVertexCorners() const;
+    void        buildPositionValueIndices(const int *corner_values, std::vector<int> &dst) const;
+    const abcV4* getTangents() const;
+    aiSplitSource<abcV3> getSplitPositions(const aiSplitedMeshInfo &smi) const;
+    aiSplitSource<abcV3> getSplitNormals(const aiSplitedMeshInfo &smi) const;
+    aiSplitSource<abcV2> getSplitUVs(const aiSplitedMeshInfo &smi) const;
+    void        packTextureData(aiTextureMeshBuffer &buf) const;
+    void        writeOutputBuffersAhead();
+    void        writeChangedOutputs(aiMeshOutputResult &o_result, int max_vertices);
+    bool        hasFreshOutputs() const;
+    int         getOutputOptions() const;
 
 private:
     AbcGeom::IPolyMeshSchema m_schema;
@@ -76,6 +307,62 @@ private:
     AbcGeom::IN3fGeomParam::Sample m_normals;
     AbcGeom::IV2fGeomParam::Sample m_uvs;
     Abc::V3fArraySamplePtr m_velocities;
+
+    aiSampleState m_indices_state;
+    aiSampleState m_counts_state;
+    aiSampleState m_positions_state;
+    aiSampleState m_velocities_state;
+    aiSampleState m_normals_state;
+    aiSampleState m_normal_indices_state;
+    aiSampleState m_uvs_state;
+    aiSampleState m_uv_indices_state;
+    int m_dirty_flags;
+    // the sample after the current one, kept for aiSubframeMode_Linear
+    Abc::index_t m_next_index;
+    Abc::P3fArraySamplePtr m_next_positions;
+    AbcGeom::IN3fGeomParam::Sample m_next_normals;
+    aiSampleState m_next_normal_indices_state;
+    // positions and normals at the current time between samples, with aiSubframeMode_Velocity or aiSubframeMode_Linear
+    std::vector<abcV3> m_subframe_positions;
+    std::vector<abcV3> m_subframe_normals;
+    float m_subframe_param;     // time offset or blend weight they were made with
+    bool m_use_subframe_positions;
+    bool m_use_subframe_normals;
+
+    mutable aiTopologyCache m_topology;
+    // smooth normals of each position, when the mesh has none and they are to be generated
+    mutable std::vector<abcV3> m_generated_normals;
+    mutable std::vector<abcV3> m_corner_normals;
+    mutable bool m_generated_normals_dirty;
+    // tangent of each face corner
+    mutable std::vector<abcV4> m_tangents;
+    mutable std::vector<abcV3> m_corner_tangents;
+    mutable std::vector<abcV3> m_corner_bitangents;
+    mutable bool m_tangents_dirty;
+    // null until copyDataToTexture() is first called. shared only so that aiPolyMesh stays copyable
+    std::shared_ptr<aiTextureMeshBuffers> m_texture;
+    std::vector<aiMeshOutputBuffers> m_outputs; // of each split
+    int m_output_formats[aiMeshOutputSlot_Count];
+    // what updateSample() wrote into the buffers, handed out by the next writeOutputBuffers()
+    aiMeshOutputResult m_output_result;
+    std::vector<aiMeshSplitCounts> m_output_split_counts;
+    int m_output_max_vertices;  // of the last writeOutputBuffers(). 0: not called yet, nothing is written ahead
+    int m_output_options;       // getOutputOptions() the buffers were last written with
+    bool m_output_pending;
+    // bounds of the current sample for the quantized formats. made on first use
+    mutable aiQuantizationParams m_quantization;
+    mutable bool m_position_bounds_dirty;
+    mutable bool m_uv_bounds_dirty;
+    mutable bool m_bounds_reverse_x;
+    // baked cache played instead of m_schema, if not null. m_baked_frame points to the data of the current frame
+    const aiBakedCache *m_baked;
+    int m_baked_index;
+    const aiBakedMeshFrame *m_baked_frame;
+    std::vector<int> m_baked_index_offsets;     // of each split of the frame
+    std::vector<int> m_baked_vertex_offsets;
+    // positions come from here instead of m_schema, if not null
+    const aiDeltaCache *m_deltas;
+    int m_delta_index;
 };
 
 
@@ -87,8 +374,36 @@ public:
     aiCurves(aiObject *obj);
     void updateSample() override;
 
+    int         getDirtyFlags() const; // combination of aiCurvesProperty flags changed by the last updateSample()
+    int         getNumCurves() const;
+    int         getVertexCount() const;
+    bool        hasWidths() const;
+    int         getSplits(aiCurvesSplitInfo *dst, int max_splits, int max_vertices) const;
+    void        copySplitData(aiCurvesData &dst, const aiCurvesSplitInfo &split) const;
+
+private:
+    void        updateTopology() const;
+    void        buildSplits(int max_vertices) const;
+
 private:
     AbcGeom::ICurvesSchema m_schema;
+    Abc::IScalarProperty m_basis_and_type;
+    Abc::P3fArraySamplePtr m_positions;
+    Abc::Int32ArraySamplePtr m_counts;
+    AbcGeom::IFloatGeomParam::Sample m_widths; // expanded
+    aiSampleState m_positions_state;
+    aiSampleState m_counts_state;
+    aiSampleState m_widths_state;
+    aiSampleState m_width_indices_state;
+    Abc::index_t m_basis_index;
+    bool m_periodic;
+    int m_dirty_flags;
+    // made from m_counts on first use after it changes
+    mutable bool m_topology_dirty;
+    mutable std::vector<int> m_offsets; // first vertex of each curve, and the number of vertices at the end
+    mutable std::vector<aiCurvesSplitInfo> m_splits;
+    mutable std::vector<int> m_indices; // line lists of all splits, relative to their first vertex
+    mutable int m_split_max_vertices;   // the splits were made with. 0: not made yet
 };
 
 
@@ -100,8 +415,30 @@ public:
     aiPoints(aiObject *obj);
     void updateSample() override;
 
+    void        enableSort(bool v);
+    bool        hasVelocities() const;
+    int         getDirtyFlags() const; // combination of aiPointsProperty flags changed by the last updateSample()
+    int         getCount() const;
+    // positions and velocities with reverse-X applied, in id order if sorting is on. false if dst is too small
+    bool        copyData(aiPointsData &dst) const;
+
+private:
+    bool        hasIDs() const;
+    const int*  getOrder() const;
+
 private:
     AbcGeom::IPointsSchema m_schema;
+    Abc::P3fArraySamplePtr m_positions;
+    Abc::V3fArraySamplePtr m_velocities;
+    Abc::UInt64ArraySamplePtr m_ids;
+    aiSampleState m_positions_state;
+    aiSampleState m_velocities_state;
+    aiSampleState m_ids_state;
+    int m_dirty_flags;
+    bool m_sort;
+    // sample index of each point in id order. made on first use after the ids change, empty if they are in order already
+    mutable std::vector<int> m_order;
+    mutable bool m_order_dirty;
 };
 
 
@@ -122,12 +459,19 @@ public:
     aiCamera();
     aiCamera(aiObject *obj);
     void updateSample() override;
+    // reads the parameters of all samples, which updateSample() then only looks up
+    void preloadTrack();
 
     void getParams(aiCameraParams &o_params);
 
+private:
+    static void toParams(const AbcGeom::CameraSample &sample, aiCameraParams &o_params);
+
 private:
     AbcGeom::ICameraSchema m_schema;
-    AbcGeom::CameraSample m_sample;
+    aiTrack<aiCameraParams> m_track;
+    aiCameraParams m_params;
+    Abc::index_t m_sample_index;
 };
 
 
@@ -19,9 +19,13 @@ typedef aiGraphicsDevice* (*aiGetGraphicsDeviceT)();
 
 aiCLinkage aiExport void UnitySetGraphicsDevice(void* device, int deviceType, int eventType)
 {
-    if (device == nullptr) { return; }
+    if (device == nullptr && deviceType != kGfxRendererNull) { return; }
 
     if (eventType == kGfxDeviceEventInitialize) {
+        if (deviceType == kGfxRendererNull)
+        {
+            g_aiGraphicsDevice = aiCreateGraphicsDeviceNull();
+        }
 #ifdef aiSupportD3D9
         if (deviceType == kGfxRendererD3D9)
         {
@@ -14,6 +14,28 @@ private:
 };
 aiGraphicsDevice* aiCreateGraphicsDeviceD3D11(void *device);
 aiGraphicsDevice* aiCreateGraphicsDeviceOpenGL(void *device);
+aiGraphicsDevice* aiCreateGraphicsDeviceNull();
+aiCLinkage aiExport aiGraphicsDevice* aiGetGraphicsDevice();
+
+
+// used in batch mode. keeps what would have been copied to each texture, so that it can be inspected without a GPU
+class aiGraphicsDeviceNull : public aiGraphicsDevice
+{
+typedef aiGraphicsDevice super;
+public:
+    struct Texture
+    {
+        int width, height;
+        std::vector<char> data;
+    };
+
+    aiGraphicsDeviceNull();
+    virtual void copyDataToTexture(void *texptr, int width, int height, const void *data, int datasize);
+    const Texture* findTexture(void *texptr) const;
+
+private:
+    std::map<void*, Texture> m_textures;
+};
 
 
 
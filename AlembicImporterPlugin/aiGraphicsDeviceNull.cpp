@@ -0,0 +1,29 @@
+#include "pch.h"
+#include "AlembicImporter.h"
+#include "aiGraphicsDevice.h"
+
+
+aiGraphicsDevice* aiCreateGraphicsDeviceNull()
+{
+    return new aiGraphicsDeviceNull();
+}
+
+
+aiGraphicsDeviceNull::aiGraphicsDeviceNull()
+    : super(nullptr, kGfxRendererNull)
+{
+}
+
+void aiGraphicsDeviceNull::copyDataToTexture(void *texptr, int width, int height, const void *data, int datasize)
+{
+    Texture &tex = m_textures[texptr];
+    tex.width = width;
+    tex.height = height;
+    tex.data.assign((const char*)data, (const char*)data + datasize);
+}
+
+const aiGraphicsDeviceNull::Texture* aiGraphicsDeviceNull::findTexture(void *texptr) const
+{
+    auto it = m_textures.find(texptr);
+    return it != m_textures.end() ? &it->second : nullptr;
+}
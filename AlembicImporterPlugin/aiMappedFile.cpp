@@ -0,0 +1,75 @@
+﻿#include "pch.h"
+#include "aiMappedFile.h"
+
+#ifndef aiWindows
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif // aiWindows
+
+
+aiMappedFile::aiMappedFile()
+    : m_data(nullptr)
+    , m_size(0)
+#ifdef aiWindows
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+#endif // aiWindows
+{
+}
+
+aiMappedFile::~aiMappedFile()
+{
+    close();
+}
+
+bool aiMappedFile::open(const char *path)
+{
+    close();
+
+#ifdef aiWindows
+    m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER size;
+    if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+        close();
+        return false;
+    }
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void *data = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (data == nullptr) {
+        close();
+        return false;
+    }
+    m_size = (uint64_t)size.QuadPart;
+#else // aiWindows
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) { return false; }
+    struct stat st;
+    void *data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    // the mapping stays valid without the descriptor
+    ::close(fd);
+    if (data == MAP_FAILED) { return false; }
+    m_size = (uint64_t)st.st_size;
+#endif // aiWindows
+    m_data = (const char*)data;
+    return true;
+}
+
+void aiMappedFile::close()
+{
+#ifdef aiWindows
+    if (m_data) { UnmapViewOfFile(m_data); }
+    if (m_mapping) { CloseHandle(m_mapping); }
+    if (m_file != INVALID_HANDLE_VALUE) { CloseHandle(m_file); }
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+#else // aiWindows
+    if (m_data) { munmap((void*)m_data, (size_t)m_size); }
+#endif // aiWindows
+    m_data = nullptr;
+    m_size = 0;
+}
@@ -0,0 +1,30 @@
+﻿#ifndef aiMappedFile_h
+#define aiMappedFile_h
+
+// read-only memory mapping of a whole file
+class aiMappedFile
+{
+public:
+    aiMappedFile();
+    ~aiMappedFile();
+    // fails on empty files
+    bool open(const char *path);
+    void close();
+
+    const char* getData() const { return m_data; }
+    uint64_t    getSize() const { return m_size; }
+
+private:
+    aiMappedFile(const aiMappedFile&);
+    aiMappedFile& operator=(const aiMappedFile&);
+
+private:
+    const char *m_data;
+    uint64_t m_size;
+#ifdef aiWindows
+    HANDLE m_file;
+    HANDLE m_mapping;
+#endif // aiWindows
+};
+
+#endif // aiMappedFile_h
@@ -3,14 +3,29 @@
 #include "aiGeometry.h"
 #include "aiContext.h"
 #include "aiObject.h"
+#include "aiBakedCache.h"
 
 aiObject::aiObject(aiContext *ctx, abcObject &abc)
     : m_ctx(ctx)
     , m_abc(abc)
+    , m_name(nullptr)
+    , m_full_name(nullptr)
+    , m_parent(nullptr)
+    , m_id(0)
+    , m_visibility_index(-1)
+    , m_baked(nullptr)
+    , m_baked_visibility(-1)
+    , m_visibility(AbcGeom::kVisibilityDeferred)
+    , m_visible(true)
+    , m_tracks_pending(false)
     , m_time(0.0f)
     , m_reverse_x(true)
     , m_triangulate(true)
     , m_reverse_index(false)
+    , m_share_vertices(false)
+    , m_generate_normals(false)
+    , m_generate_tangents(false)
+    , m_subframe_mode(aiSubframeMode_Nearest)
 {
 #ifdef aiDebug
     m_magic = aiMagicObj;
@@ -18,6 +33,8 @@ aiObject::aiObject(aiContext *ctx, abcObject &abc)
 
     if (m_abc.valid())
     {
+        m_visibility_prop = AbcGeom::GetVisibilityProperty(m_abc);
+
         const auto& metadata = m_abc.getMetaData();
         
         m_has_xform = AbcGeom::IXformSchema::matches(metadata);
@@ -75,6 +92,57 @@ aiObject::aiObject(aiContext *ctx, abcObject &abc)
     }
 }
 
+aiObject::aiObject(aiContext *ctx, const aiBakedCache &cache, int node)
+    : m_ctx(ctx)
+    , m_parent(nullptr)
+    , m_id(0)
+    , m_has_xform(false)
+    , m_has_polymesh(false)
+    , m_has_curves(false)
+    , m_has_points(false)
+    , m_has_camera(false)
+    , m_has_light(false)
+    , m_has_material(false)
+    , m_visibility_index(-1)
+    , m_baked(nullptr)
+    , m_baked_visibility(-1)
+    , m_visibility(AbcGeom::kVisibilityDeferred)
+    , m_visible(true)
+    , m_tracks_pending(false)
+    , m_time(0.0f)
+    , m_reverse_x(true)
+    , m_triangulate(true)
+    , m_reverse_index(false)
+    , m_share_vertices(false)
+    , m_generate_normals(false)
+    , m_generate_tangents(false)
+    , m_subframe_mode(aiSubframeMode_Nearest)
+{
+#ifdef aiDebug
+    m_magic = aiMagicObj;
+#endif // aiDebug
+
+    const aiBakedNode &bn = cache.getNode(node);
+    m_name = cache.getString(bn.name);
+    m_full_name = cache.getString(bn.full_name);
+    m_baked = &cache;
+    m_baked_visibility = bn.visibility;
+
+    m_has_xform = bn.xform >= 0;
+    if (m_has_xform)
+    {
+        m_xform = aiXForm(this, &cache, bn.xform);
+        m_schemas.push_back(&m_xform);
+    }
+
+    m_has_polymesh = bn.mesh >= 0;
+    if (m_has_polymesh)
+    {
+        m_polymesh = aiPolyMesh(this, &cache, bn.mesh);
+        m_schemas.push_back(&m_polymesh);
+    }
+}
+
 aiObject::~aiObject()
 {
 }
@@ -82,30 +150,141 @@ aiObject::~aiObject()
 void aiObject::addChild(aiObject *c)
 {
     m_children.push_back(c);
+    c->m_parent = this;
 }
 
 aiContext*  aiObject::getContext()          { return m_ctx; }
 abcObject&  aiObject::getAbcObject()        { return m_abc; }
-const char* aiObject::getName() const       { return m_abc.getName().c_str(); }
-const char* aiObject::getFullName() const   { return m_abc.getFullName().c_str(); }
+const char* aiObject::getName() const       { return m_name ? m_name : m_abc.getName().c_str(); }
+const char* aiObject::getFullName() const   { return m_full_name ? m_full_name : m_abc.getFullName().c_str(); }
 uint32_t    aiObject::getNumChildren() const{ return m_children.size(); }
-aiObject*   aiObject::getChild(int i)       { return m_children[i]; }
+
+aiObject* aiObject::getChild(int i)
+{
+    aiObject *&child = m_children[i];
+    if (child == nullptr) {
+        // update tasks walk m_children and read the node lists, and HDF5 archives from one thread only.
+        // the child is published once the context knows it
+        m_ctx->waitTasks();
+        abcObject abc = m_abc.getChild(i);
+        aiObject *c = new aiObject(m_ctx, abc);
+        c->m_parent = this;
+        m_ctx->addNode(c);
+        child = c;
+    }
+    return child;
+}
+
+aiObject* aiObject::findChild(int i)
+{
+    return m_children[i];
+}
+
+void aiObject::setLazyChildren()
+{
+    m_children.assign(m_abc.getNumChildren(), nullptr);
+}
+aiObject*   aiObject::getParent()           { return m_parent; }
+int         aiObject::getID() const         { return m_id; }
+void        aiObject::setID(int id)         { m_id = id; }
 
 void aiObject::setCurrentTime(float time)
 {
+    updateVisibility(time);
+    updateSamples(time);
+}
+
+void aiObject::updateVisibility(float time)
+{
+    preloadPendingTracks();
+    if (m_baked) {
+        if (m_baked_visibility >= 0) {
+            int frame = m_baked->getFrame(time);
+            if (frame != m_visibility_index) {
+                m_visibility_index = frame;
+                m_visibility = m_baked->getVisibility(frame, m_baked_visibility);
+            }
+        }
+    }
+    else if (m_visibility_track.valid()) {
+        m_visibility = m_visibility_track.getNear(time);
+    }
+    else if (m_visibility_prop.valid()) {
+        Abc::index_t index = Abc::ISampleSelector(time).getIndex(m_visibility_prop.getTimeSampling(), m_visibility_prop.getNumSamples());
+        if (index != m_visibility_index) {
+            m_visibility_index = index;
+            m_visibility = m_visibility_prop.getValue(Abc::ISampleSelector(index));
+        }
+    }
+    // as IsAncestorInvisible(): a hidden node hides its whole subtree, whatever its descendants say
+    m_visible = m_visibility != AbcGeom::kVisibilityHidden && (!m_parent || m_parent->m_visible);
+}
+
+void aiObject::hideSubtree()
+{
+    m_visible = false;
+    for (auto c : m_children) {
+        if (c) { c->hideSubtree(); }
+    }
+}
+
+void aiObject::updateSamples(float time)
+{
+    preloadPendingTracks();
     m_time = time;
     for (auto s : m_schemas) {
         s->updateSample();
     }
 }
+
+void aiObject::preloadTracks()
+{
+    if (m_has_xform)  { m_xform.preloadTrack(); }
+    if (m_has_camera) { m_camera.preloadTrack(); }
+
+    size_t num_samples = m_visibility_prop.valid() ? m_visibility_prop.getNumSamples() : 0;
+    if (num_samples > 0) {
+        aiTrack<int8_t> track;
+        track.times = m_ctx->getTrackTimes(m_visibility_prop.getTimeSampling(), num_samples);
+        track.samples.resize(num_samples);
+        for (size_t i = 0; i < num_samples; ++i) {
+            track.samples[i] = m_visibility_prop.getValue(Abc::ISampleSelector((Abc::index_t)i));
+        }
+        m_visibility_track = std::move(track);
+    }
+}
+
+void aiObject::preloadTracksLater()
+{
+    m_tracks_pending = true;
+}
+
+void aiObject::preloadPendingTracks()
+{
+    if (m_tracks_pending) {
+        // cleared first, so that a failed preload falls back on reading samples instead of retrying every update
+        m_tracks_pending = false;
+        preloadTracks();
+    }
+}
 void aiObject::enableReverseX(bool v)       { m_reverse_x = v; }
 void aiObject::enableTriangulate(bool v)    { m_triangulate = v; }
 void aiObject::enableReverseIndex(bool v)   { m_reverse_index = v; }
+void aiObject::enableShareVertices(bool v)  { m_share_vertices = v; }
+void aiObject::enableGenerateNormals(bool v) { m_generate_normals = v; }
+void aiObject::enableGenerateTangents(bool v) { m_generate_tangents = v; }
+void aiObject::setSubframeMode(int v)       { m_subframe_mode = v; }
 
 float aiObject::getCurrentTime() const      { return m_time; }
 bool aiObject::getReverseX() const          { return m_reverse_x; }
 bool aiObject::getReverseIndex() const      { return m_reverse_index; }
 bool aiObject::getTriangulate() const       { return m_triangulate; }
+bool aiObject::getShareVertices() const     { return m_share_vertices; }
+bool aiObject::getGenerateNormals() const   { return m_generate_normals; }
+bool aiObject::getGenerateTangents() const  { return m_generate_tangents; }
+int aiObject::getSubframeMode() const       { return m_subframe_mode; }
+int aiObject::getVisibility() const         { return m_visibility; }
+bool aiObject::isVisible() const            { return m_visible; }
 
 
 bool aiObject::hasXForm() const    { return m_has_xform; }
@@ -115,6 +294,7 @@ bool aiObject::hasPoints() const   { return m_has_points; }
 bool aiObject::hasCamera() const   { return m_has_camera; }
 bool aiObject::hasLight() const    { return m_has_light; }
 bool aiObject::hasMaterial() const { return m_has_material; }
+bool aiObject::hasVisibility() const { return m_baked ? m_baked_visibility >= 0 : m_visibility_prop.valid(); }
 
 aiXForm&    aiObject::getXForm()      { return m_xform; }
 aiPolyMesh& aiObject::getPolyMesh()   { return m_polymesh; }
@@ -3,6 +3,7 @@
 
 #include "aiGeometry.h"
 class aiContext;
+class aiBakedCache;
 const int aiMagicObj = 0x004a424f; // "OBJ"
 
 
@@ -10,17 +11,37 @@ class aiObject
 {
 public:
     aiObject(aiContext *ctx, abcObject &abc);
+    // node of a baked cache. it has no abcObject, and only xform and polymesh schemas
+    aiObject(aiContext *ctx, const aiBakedCache &cache, int node);
     ~aiObject();
 
     const char* getName() const;
     const char* getFullName() const;
     uint32_t    getNumChildren() const;
+    // with the lazy hierarchy, the child and its schemas are made on the first call, which waits for the update
     aiObject*   getChild(int i);
+    // null if the lazy hierarchy hasn't made the child yet. never makes it, so that update tasks can walk the tree
+    aiObject*   findChild(int i);
 
+    // updateVisibility() then updateSamples()
     void setCurrentTime(float time);
+    // evaluates the visibility property at time, and whether the node is visible. the parent's must be done first.
+    // the property is read only when its sample changes
+    void updateVisibility(float time);
+    // marks the node and all its descendants made so far hidden without evaluating anything, as under a hidden node
+    void hideSubtree();
+    void updateSamples(float time);
+    // reads the xform, camera and visibility samples of the whole time range, so that setCurrentTime() only looks them up
+    void preloadTracks();
+    // leaves preloadTracks() to the next updateVisibility() or updateSamples(), so that an update task does it
+    void preloadTracksLater();
     void enableReverseX(bool v);
     void enableTriangulate(bool v);
     void enableReverseIndex(bool v);
+    void enableShareVertices(bool v);
+    void enableGenerateNormals(bool v);
+    void enableGenerateTangents(bool v);
+    void setSubframeMode(int v);
 
     bool        hasXForm() const;
     bool        hasPolyMesh() const;
@@ -29,6 +50,8 @@ public:
     bool        hasCamera() const;
     bool        hasLight() const;
     bool        hasMaterial() const;
+    // true if the node has a visibility property, or a visibility track in the baked cache
+    bool        hasVisibility() const;
     aiXForm&    getXForm();
     aiPolyMesh& getPolyMesh();
     aiCurves&   getCurves();
@@ -41,10 +64,26 @@ public:
     aiContext*  getContext();
     abcObject&  getAbcObject();
     void        addChild(aiObject *c);
+    // lazy hierarchy: the children are left to getChild()
+    void        setLazyChildren();
+    void        preloadPendingTracks();
+    aiObject*   getParent();
+    // index in the context's node list. parents always have smaller ids than their children
+    int         getID() const;
+    void        setID(int id);
     float       getCurrentTime() const;
     bool        getReverseX() const;
     bool        getReverseIndex() const;
     bool        getTriangulate() const;
+    bool        getShareVertices() const;
+    bool        getGenerateNormals() const;
+    bool        getGenerateTangents() const;
+    int         getSubframeMode() const;
+    // AbcGeom::ObjectVisibility of the node itself at the current time. kVisibilityDeferred without visibility property.
+    // with visibility culling, left as it was under hidden nodes
+    int         getVisibility() const;
+    // false if the node or any of its ancestors is hidden
+    bool        isVisible() const;
 
 private:
 #ifdef aiDebug
@@ -52,7 +91,11 @@ private:
 #endif // aiDebug
     aiContext   *m_ctx;
     abcObject   m_abc;
+    const char  *m_name;        // of baked cache nodes, in the cache. null otherwise
+    const char  *m_full_name;
+    aiObject    *m_parent;
     std::vector<aiObject*> m_children;
+    int         m_id;
 
     std::vector<aiSchema*> m_schemas;
     aiXForm     m_xform;
@@ -70,10 +113,23 @@ private:
     bool        m_has_light;
     bool        m_has_material;
 
+    AbcGeom::IVisibilityProperty m_visibility_prop;
+    aiTrack<int8_t> m_visibility_track;
+    Abc::index_t m_visibility_index; // of the sample m_visibility was read from
+    const aiBakedCache *m_baked;    // for nodes of a baked cache, m_visibility comes from here
+    int         m_baked_visibility; // index in the visibilities of each frame. -1: none
+    int8_t      m_visibility;
+    bool        m_visible;
+    bool        m_tracks_pending; // preloadTracksLater()
+
     float m_time;
     bool m_reverse_x;
     bool m_triangulate;
     bool m_reverse_index;
+    bool m_share_vertices;
+    bool m_generate_normals;
+    bool m_generate_tangents;
+    int m_subframe_mode;
 };
 
 
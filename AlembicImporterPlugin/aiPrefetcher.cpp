@@ -0,0 +1,137 @@
+#include "pch.h"
+#include "AlembicImporter.h"
+#include "aiGeometry.h"
+#include "aiObject.h"
+#include "aiPrefetcher.h"
+
+
+aiPrefetcher::aiPrefetcher()
+    : m_max_bytes(0)
+    , m_num_bytes(0)
+    , m_generation(0)
+{
+}
+
+aiPrefetcher::~aiPrefetcher()
+{
+    wait();
+}
+
+void aiPrefetcher::setCapacity(uint64_t max_bytes)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_max_bytes = max_bytes;
+}
+
+uint64_t aiPrefetcher::getCapacity() const
+{
+    return m_max_bytes;
+}
+
+void aiPrefetcher::prefetch(const std::vector<aiPolyMesh*> &meshes, float current_time, const float *times, int num_times)
+{
+    std::vector<Key> to_read;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_max_bytes == 0) { return; }
+
+        int generation = ++m_generation;
+        for (auto mesh : meshes) {
+            if (mesh->getNumSamples() <= 1) { continue; }
+
+            auto it = m_entries.find(Key(mesh, mesh->getSampleIndex(current_time)));
+            if (it != m_entries.end()) {
+                it->second.generation = generation;
+            }
+        }
+        for (int ti = 0; ti < num_times; ++ti) {
+            for (auto mesh : meshes) {
+                if (mesh->getNumSamples() <= 1) { continue; }
+
+                Key key(mesh, mesh->getSampleIndex(times[ti]));
+                Entry &e = m_entries[key];
+                if (e.generation == 0) {
+                    to_read.push_back(key);
+                }
+                e.generation = generation;
+            }
+        }
+
+        // release samples outside the window. entries being read are erased by read()
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            if (it->second.generation != generation && it->second.sample) {
+                m_num_bytes -= it->second.size;
+                it = m_entries.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    for (auto &key : to_read) {
+        aiPolyMesh *mesh = const_cast<aiPolyMesh*>(key.first);
+        Abc::index_t index = key.second;
+        m_tasks.run([this, mesh, index](){ read(mesh, index); });
+    }
+}
+
+void aiPrefetcher::read(aiPolyMesh *mesh, Abc::index_t index)
+{
+    Key key(mesh, index);
+    {
+        // skip samples that fell out of the window or don't fit while this task was queued
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key);
+        if (it == m_entries.end()) { return; }
+        if (it->second.generation != m_generation || m_num_bytes >= m_max_bytes) {
+            m_entries.erase(it);
+            return;
+        }
+    }
+
+    aiPolyMeshSamplePtr sample;
+    try {
+        sample = mesh->readSample(index);
+    }
+    catch (Alembic::Util::Exception e)
+    {
+        aiDebugLog("exception: %s\n", e.what());
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) { return; }
+
+    uint64_t size = sample ? sample->getSizeInBytes() : 0;
+    if (!sample || it->second.generation != m_generation || m_num_bytes + size > m_max_bytes) {
+        m_entries.erase(it);
+        return;
+    }
+    it->second.sample = sample;
+    it->second.size = size;
+    m_num_bytes += size;
+}
+
+aiPolyMeshSamplePtr aiPrefetcher::find(const aiPolyMesh *mesh, Abc::index_t index)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_entries.empty()) { return aiPolyMeshSamplePtr(); }
+
+    auto it = m_entries.find(Key(mesh, index));
+    return it != m_entries.end() ? it->second.sample : aiPolyMeshSamplePtr();
+}
+
+void aiPrefetcher::clear()
+{
+    wait();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_num_bytes = 0;
+}
+
+void aiPrefetcher::wait()
+{
+    m_tasks.wait();
+}
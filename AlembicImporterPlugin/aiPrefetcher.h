@@ -0,0 +1,54 @@
+﻿#ifndef aiPrefetcher_h
+#define aiPrefetcher_h
+
+#include "aiThreadPool.h"
+
+class aiPolyMesh;
+struct aiPolyMeshSample;
+typedef std::shared_ptr<aiPolyMeshSample> aiPolyMeshSamplePtr;
+
+
+// reads mesh samples of upcoming frames on the thread pool and holds them until they are consumed
+// by aiPolyMesh::updateSample() or fall out of the look-ahead window.
+// samples are read in the order of the requested times, and only while the held samples fit in the budget.
+class aiPrefetcher
+{
+public:
+    aiPrefetcher();
+    ~aiPrefetcher();
+
+    // 0: disabled
+    void setCapacity(uint64_t max_bytes);
+    uint64_t getCapacity() const;
+
+    // samples at current_time are kept (it is being consumed), samples at times are read if not held yet.
+    // everything else is released.
+    void prefetch(const std::vector<aiPolyMesh*> &meshes, float current_time, const float *times, int num_times);
+    // returns null if the sample is not ready
+    aiPolyMeshSamplePtr find(const aiPolyMesh *mesh, Abc::index_t index);
+    void clear();
+    void wait();
+
+private:
+    typedef std::pair<const aiPolyMesh*, Abc::index_t> Key;
+    struct Entry
+    {
+        Entry() : generation(0), size(0) {}
+        aiPolyMeshSamplePtr sample; // null while being read
+        int generation; // last prefetch() that wanted this sample
+        uint64_t size;
+    };
+    typedef std::map<Key, Entry> Entries;
+
+    void read(aiPolyMesh *mesh, Abc::index_t index);
+
+private:
+    std::mutex m_mutex;
+    Entries m_entries;
+    aiTaskGroup m_tasks;
+    uint64_t m_max_bytes;
+    uint64_t m_num_bytes;
+    int m_generation;
+};
+
+#endif // aiPrefetcher_h
@@ -0,0 +1,881 @@
+#include "pch.h"
+#include "aiSIMD.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+    #define aiSIMDX86
+#endif
+
+#ifdef aiSIMDX86
+#include <immintrin.h>
+#ifdef _MSC_VER
+    #include <intrin.h>
+    // MSVC allows any intrinsic in any function
+    #define aiTargetSSE41
+    #define aiTargetAVX2
+#else
+    #include <cpuid.h>
+    #define aiTargetSSE41 __attribute__((target("sse4.1")))
+    #define aiTargetAVX2  __attribute__((target("avx2,f16c")))
+#endif
+#endif // aiSIMDX86
+
+
+// scalar
+
+template<bool ReverseX>
+static void aiCopyPointsScalar(abcV3 *dst, const abcV3 *src, size_t num)
+{
+    for (size_t i = 0; i < num; ++i) {
+        dst[i] = src[i];
+        if (ReverseX) { dst[i].x *= -1.0f; }
+    }
+}
+
+template<bool ReverseX>
+static void aiGatherPointsScalar(abcV3 *dst, const abcV3 *src, const int *indices, size_t num)
+{
+    for (size_t i = 0; i < num; ++i) {
+        dst[i] = src[indices[i]];
+        if (ReverseX) { dst[i].x *= -1.0f; }
+    }
+}
+
+static void aiGatherPointsScalar(abcV2 *dst, const abcV2 *src, const int *indices, size_t num)
+{
+    for (size_t i = 0; i < num; ++i) {
+        dst[i] = src[indices[i]];
+    }
+}
+
+static void aiCopyIndicesReverseScalar(int *dst, const int *src, size_t num)
+{
+    for (size_t i = 0; i < num; ++i) {
+        dst[i] = src[num - i - 1];
+    }
+}
+
+// points are just treated as num * 3 floats
+static void aiExtrapolateScalar(float *dst, const float *p, const float *v, size_t num, float dt)
+{
+    for (size_t i = 0; i < num; ++i) {
+        dst[i] = p[i] + v[i] * dt;
+    }
+}
+
+static void aiLerpScalar(float *dst, const float *a, const float *b, size_t num, float t)
+{
+    for (size_t i = 0; i < num; ++i) {
+        dst[i] = a[i] + (b[i] - a[i]) * t;
+    }
+}
+
+template<bool ReverseX>
+static void aiExpandPointsScalar(abcV4 *dst, const abcV3 *src, size_t num, float w)
+{
+    for (size_t i = 0; i < num; ++i) {
+        dst[i] = abcV4(ReverseX ? -src[i].x : src[i].x, src[i].y, src[i].z, w);
+    }
+}
+
+template<class T>
+static void aiDecodeDeltaPointsScalar(abcV3 *dst, const abcV3 *key, const T *deltas, size_t num, const abcV3 &step)
+{
+    for (size_t i = 0; i < num; ++i) {
+        const T *d = deltas + i * 3;
+        dst[i] = abcV3(
+            key[i].x + float(d[0]) * step.x,
+            key[i].y + float(d[1]) * step.y,
+            key[i].z + float(d[2]) * step.z);
+    }
+}
+
+// the quantizers read src[indices[i]] if Indexed, src[i] otherwise. x is multiplied by x_sign (1 or -1), which is exact.
+// every step is done in the same order as the SIMD versions so that the results are the same bits
+
+template<bool Indexed>
+static inline size_t aiSourceIndex(const int *indices, size_t i)
+{
+    return Indexed ? (size_t)indices[i] : i;
+}
+
+static inline uint16_t aiToUNorm16(float v)
+{
+    v = std::min<float>(std::max<float>(v, 0.0f), 65535.0f);
+    return (uint16_t)(int)(v + 0.5f);
+}
+
+static inline int16_t aiToSNorm16(float v)
+{
+    v = std::min<float>(std::max<float>(v, -1.0f), 1.0f) * 32767.0f;
+    return (int16_t)(int)(v + std::copysign(0.5f, v));
+}
+
+template<bool Indexed>
+static void aiQuantizePointsUNorm16Scalar(uint16_t *dst, const abcV3 *src, const int *indices, size_t num,
+    const abcV3 &bmin, const abcV3 &scale, float x_sign)
+{
+    for (size_t i = 0; i < num; ++i) {
+        abcV3 p = src[aiSourceIndex<Indexed>(indices, i)];
+        uint16_t *d = dst + i * 4;
+        d[0] = aiToUNorm16((p.x * x_sign - bmin.x) * scale.x);
+        d[1] = aiToUNorm16((p.y - bmin.y) * scale.y);
+        d[2] = aiToUNorm16((p.z - bmin.z) * scale.z);
+        d[3] = 0xffff;
+    }
+}
+
+template<bool Indexed>
+static void aiQuantizePointsHalfScalar(uint16_t *dst, const abcV3 *src, const int *indices, size_t num, float x_sign)
+{
+    for (size_t i = 0; i < num; ++i) {
+        abcV3 p = src[aiSourceIndex<Indexed>(indices, i)];
+        uint16_t *d = dst + i * 4;
+        d[0] = half(p.x * x_sign).bits();
+        d[1] = half(p.y).bits();
+        d[2] = half(p.z).bits();
+        d[3] = half(1.0f).bits();
+    }
+}
+
+template<bool Indexed>
+static void aiQuantizeNormalsOct16Scalar(int16_t *dst, const abcV3 *src, const int *indices, size_t num, float x_sign)
+{
+    for (size_t i = 0; i < num; ++i) {
+        abcV3 n = src[aiSourceIndex<Indexed>(indices, i)];
+        n.x *= x_sign;
+        // onto the octahedron |x| + |y| + |z| = 1, lower half folded over the upper one
+        float l = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        float r = l > 0.0f ? 1.0f / l : 0.0f;
+        float x = n.x * r, y = n.y * r, z = n.z * r;
+        if (z < 0.0f) {
+            float fx = (1.0f - std::abs(y)) * std::copysign(1.0f, x);
+            float fy = (1.0f - std::abs(x)) * std::copysign(1.0f, y);
+            x = fx;
+            y = fy;
+        }
+        dst[i * 2 + 0] = aiToSNorm16(x);
+        dst[i * 2 + 1] = aiToSNorm16(y);
+    }
+}
+
+template<bool Indexed>
+static void aiQuantizeUVsUNorm16Scalar(uint16_t *dst, const abcV2 *src, const int *indices, size_t num,
+    const abcV2 &bmin, const abcV2 &scale)
+{
+    for (size_t i = 0; i < num; ++i) {
+        abcV2 t = src[aiSourceIndex<Indexed>(indices, i)];
+        dst[i * 2 + 0] = aiToUNorm16((t.x - bmin.x) * scale.x);
+        dst[i * 2 + 1] = aiToUNorm16((t.y - bmin.y) * scale.y);
+    }
+}
+
+template<class T>
+static void aiComputeBoundsScalar(const T *src, size_t num, T &o_min, T &o_max)
+{
+    for (size_t i = 0; i < num; ++i) {
+        for (unsigned c = 0; c < T::dimensions(); ++c) {
+            o_min[c] = std::min<float>(o_min[c], src[i][c]);
+            o_max[c] = std::max<float>(o_max[c], src[i][c]);
+        }
+    }
+}
+
+
+#ifdef aiSIMDX86
+
+// SSE4.1
+
+// 4 points (12 floats) per iteration, the sign of every 3rd float flipped
+aiTargetSSE41 static void aiCopyPointsReverseXSSE41(abcV3 *dst, const abcV3 *src, size_t num)
+{
+    const float *s = &src[0].x;
+    float *d = &dst[0].x;
+    const __m128 m0 = _mm_castsi128_ps(_mm_setr_epi32(0x80000000, 0, 0, 0x80000000));
+    const __m128 m1 = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0x80000000, 0));
+    const __m128 m2 = _mm_castsi128_ps(_mm_setr_epi32(0, 0x80000000, 0, 0));
+
+    size_t nb = num / 4;
+    for (size_t b = 0; b < nb; ++b) {
+        _mm_storeu_ps(d + 0, _mm_xor_ps(_mm_loadu_ps(s + 0), m0));
+        _mm_storeu_ps(d + 4, _mm_xor_ps(_mm_loadu_ps(s + 4), m1));
+        _mm_storeu_ps(d + 8, _mm_xor_ps(_mm_loadu_ps(s + 8), m2));
+        s += 12;
+        d += 12;
+    }
+    aiCopyPointsScalar<true>(dst + nb * 4, src + nb * 4, num - nb * 4);
+}
+
+// loads exactly 12 bytes, stores 16. the extra float spills into the next point which is written afterwards,
+// so the last point goes through the scalar path
+template<bool ReverseX>
+aiTargetSSE41 static void aiGatherPointsSSE41(abcV3 *dst, const abcV3 *src, const int *indices, size_t num)
+{
+    if (num == 0) { return; }
+
+    const __m128 sign = _mm_castsi128_ps(_mm_setr_epi32(0x80000000, 0, 0, 0));
+    size_t last = num - 1;
+    for (size_t i = 0; i < last; ++i) {
+        const float *p = &src[indices[i]].x;
+        __m128 v = _mm_castpd_ps(_mm_load_sd((const double*)p));
+        v = _mm_insert_ps(v, _mm_load_ss(p + 2), 0x20);
+        if (ReverseX) { v = _mm_xor_ps(v, sign); }
+        _mm_storeu_ps(&dst[i].x, v);
+    }
+    aiGatherPointsScalar<ReverseX>(dst + last, src, indices + last, 1);
+}
+
+aiTargetSSE41 static void aiGatherPointsSSE41(abcV2 *dst, const abcV2 *src, const int *indices, size_t num)
+{
+    size_t nb = num / 2;
+    for (size_t b = 0; b < nb; ++b) {
+        const int *idx = indices + b * 2;
+        __m128 v = _mm_castpd_ps(_mm_load_sd((const double*)&src[idx[0]]));
+        v = _mm_loadh_pi(v, (const __m64*)&src[idx[1]]);
+        _mm_storeu_ps(&dst[b * 2].x, v);
+    }
+    aiGatherPointsScalar(dst + nb * 2, src, indices + nb * 2, num - nb * 2);
+}
+
+aiTargetSSE41 static void aiCopyIndicesReverseSSE41(int *dst, const int *src, size_t num)
+{
+    size_t nb = num / 4;
+    for (size_t b = 0; b < nb; ++b) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + num - (b + 1) * 4));
+        _mm_storeu_si128((__m128i*)(dst + b * 4), _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3)));
+    }
+    size_t done = nb * 4;
+    aiCopyIndicesReverseScalar(dst + done, src, num - done);
+}
+
+// no fma, so that all instruction sets give the same results
+aiTargetSSE41 static void aiExtrapolateSSE41(float *dst, const float *p, const float *v, size_t num, float dt)
+{
+    const __m128 t = _mm_set1_ps(dt);
+    size_t nb = num / 4;
+    for (size_t b = 0; b < nb; ++b) {
+        size_t i = b * 4;
+        _mm_storeu_ps(dst + i, _mm_add_ps(_mm_loadu_ps(p + i), _mm_mul_ps(_mm_loadu_ps(v + i), t)));
+    }
+    size_t done = nb * 4;
+    aiExtrapolateScalar(dst + done, p + done, v + done, num - done, dt);
+}
+
+aiTargetSSE41 static void aiLerpSSE41(float *dst, const float *a, const float *b, size_t num, float t)
+{
+    const __m128 w = _mm_set1_ps(t);
+    size_t nb = num / 4;
+    for (size_t bi = 0; bi < nb; ++bi) {
+        size_t i = bi * 4;
+        __m128 va = _mm_loadu_ps(a + i);
+        _mm_storeu_ps(dst + i, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b + i), va), w)));
+    }
+    size_t done = nb * 4;
+    aiLerpScalar(dst + done, a + done, b + done, num - done, t);
+}
+
+// 4 points (12 floats) in, 4 float4 out per iteration. there is no gain in going wider with AVX2, this is bound by stores
+template<bool ReverseX>
+aiTargetSSE41 static void aiExpandPointsSSE41(abcV4 *dst, const abcV3 *src, size_t num, float w)
+{
+    const __m128 vw = _mm_set1_ps(w);
+    const __m128 sign = _mm_castsi128_ps(_mm_setr_epi32(0x80000000, 0, 0, 0));
+    const float *s = &src[0].x;
+    float *d = &dst[0].x;
+
+    size_t nb = num / 4;
+    for (size_t b = 0; b < nb; ++b) {
+        // r0: x0 y0 z0 x1, r1: y1 z1 x2 y2, r2: z2 x3 y3 z3
+        __m128i r0 = _mm_castps_si128(_mm_loadu_ps(s + 0));
+        __m128i r1 = _mm_castps_si128(_mm_loadu_ps(s + 4));
+        __m128i r2 = _mm_castps_si128(_mm_loadu_ps(s + 8));
+        __m128 p[4] = {
+            _mm_blend_ps(_mm_castsi128_ps(r0), vw, 8),
+            _mm_blend_ps(_mm_castsi128_ps(_mm_alignr_epi8(r1, r0, 12)), vw, 8),
+            _mm_blend_ps(_mm_castsi128_ps(_mm_alignr_epi8(r2, r1, 8)), vw, 8),
+            _mm_blend_ps(_mm_castsi128_ps(_mm_alignr_epi8(r2, r2, 4)), vw, 8),
+        };
+        for (int i = 0; i < 4; ++i) {
+            _mm_storeu_ps(d + i * 4, ReverseX ? _mm_xor_ps(p[i], sign) : p[i]);
+        }
+        s += 12;
+        d += 16;
+    }
+    size_t done = nb * 4;
+    aiExpandPointsScalar<ReverseX>(dst + done, src + done, num - done, w);
+}
+
+// 4 deltas to float
+aiTargetSSE41 static inline __m128 aiLoadDeltasSSE41(const int16_t *src)
+{
+    return _mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)src)));
+}
+
+aiTargetSSE41 static inline __m128 aiLoadDeltasSSE41(const int8_t *src)
+{
+    int32_t v;
+    memcpy(&v, src, sizeof(v));
+    return _mm_cvtepi32_ps(_mm_cvtepi8_epi32(_mm_cvtsi32_si128(v)));
+}
+
+// 4 points (12 floats) per iteration. the steps repeat every 3 lanes. no fma, like the scalar version
+template<class T>
+aiTargetSSE41 static void aiDecodeDeltaPointsSSE41(abcV3 *dst, const abcV3 *key, const T *deltas, size_t num, const abcV3 &step)
+{
+    const __m128 s0 = _mm_setr_ps(step.x, step.y, step.z, step.x);
+    const __m128 s1 = _mm_setr_ps(step.y, step.z, step.x, step.y);
+    const __m128 s2 = _mm_setr_ps(step.z, step.x, step.y, step.z);
+    const float *k = &key[0].x;
+    float *d = &dst[0].x;
+
+    size_t nb = num / 4;
+    for (size_t b = 0; b < nb; ++b) {
+        size_t i = b * 12;
+        _mm_storeu_ps(d + i + 0, _mm_add_ps(_mm_loadu_ps(k + i + 0), _mm_mul_ps(aiLoadDeltasSSE41(deltas + i + 0), s0)));
+        _mm_storeu_ps(d + i + 4, _mm_add_ps(_mm_loadu_ps(k + i + 4), _mm_mul_ps(aiLoadDeltasSSE41(deltas + i + 4), s1)));
+        _mm_storeu_ps(d + i + 8, _mm_add_ps(_mm_loadu_ps(k + i + 8), _mm_mul_ps(aiLoadDeltasSSE41(deltas + i + 8), s2)));
+    }
+    size_t done = nb * 4;
+    aiDecodeDeltaPointsScalar(dst + done, key + done, deltas + done * 3, num - done, step);
+}
+
+// loads exactly 12 bytes. w is 0
+aiTargetSSE41 static inline __m128 aiLoadPointSSE41(const abcV3 &p)
+{
+    __m128 v = _mm_castpd_ps(_mm_load_sd((const double*)&p.x));
+    return _mm_insert_ps(v, _mm_load_ss(&p.z), 0x20);
+}
+
+aiTargetSSE41 static inline __m128 aiXSignMaskSSE41(float x_sign)
+{
+    return _mm_castsi128_ps(_mm_setr_epi32(x_sign < 0.0f ? 0x80000000 : 0, 0, 0, 0));
+}
+
+template<bool Indexed>
+aiTargetSSE41 static void aiQuantizePointsUNorm16SSE41(uint16_t *dst, const abcV3 *src, const int *indices, size_t num,
+    const abcV3 &bmin, const abcV3 &scale, float x_sign)
+{
+    const __m128 xsign = aiXSignMaskSSE41(x_sign);
+    const __m128 vmin = _mm_setr_ps(bmin.x, bmin.y, bmin.z, 0.0f);
+    const __m128 vscale = _mm_setr_ps(scale.x, scale.y, scale.z, 0.0f);
+    const __m128 lo = _mm_setzero_ps();
+    const __m128 hi = _mm_set1_ps(65535.0f);
+    const __m128 round = _mm_set1_ps(0.5f);
+    const __m128i w = _mm_setr_epi32(0, 0, 0, 0xffff);
+    for (size_t i = 0; i < num; ++i) {
+        __m128 v = _mm_xor_ps(aiLoadPointSSE41(src[aiSourceIndex<Indexed>(indices, i)]), xsign);
+        v = _mm_mul_ps(_mm_sub_ps(v, vmin), vscale);
+        v = _mm_min_ps(_mm_max_ps(v, lo), hi);
+        __m128i q = _mm_blend_epi16(_mm_cvttps_epi32(_mm_add_ps(v, round)), w, 0xc0);
+        _mm_storel_epi64((__m128i*)(dst + i * 4), _mm_packus_epi32(q, q));
+    }
+}
+
+template<bool Indexed>
+aiTargetSSE41 static void aiQuantizeNormalsOct16SSE41(int16_t *dst, const abcV3 *src, const int *indices, size_t num, float x_sign)
+{
+    const __m128 xsign = aiXSignMaskSSE41(x_sign);
+    const __m128 sign = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 snorm = _mm_set1_ps(32767.0f);
+    const __m128 round = _mm_set1_ps(0.5f);
+    for (size_t i = 0; i < num; ++i) {
+        __m128 v = _mm_xor_ps(aiLoadPointSSE41(src[aiSourceIndex<Indexed>(indices, i)]), xsign);
+        __m128 a = _mm_andnot_ps(sign, v);
+        __m128 l = _mm_add_ss(_mm_add_ss(a, _mm_shuffle_ps(a, a, 1)), _mm_shuffle_ps(a, a, 2));
+        __m128 r = _mm_and_ps(_mm_div_ss(one, l), _mm_cmpgt_ss(l, zero));
+        v = _mm_mul_ps(v, _mm_shuffle_ps(r, r, 0));
+
+        // (1 - |y|) * copysign(1, x), (1 - |x|) * copysign(1, y) where z < 0
+        __m128 yx = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 2, 0, 1));
+        __m128 fold = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(sign, yx)), _mm_or_ps(one, _mm_and_ps(v, sign)));
+        v = _mm_blendv_ps(v, fold, _mm_cmplt_ps(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)), zero));
+
+        v = _mm_mul_ps(_mm_min_ps(_mm_max_ps(v, lo), one), snorm);
+        __m128i q = _mm_cvttps_epi32(_mm_add_ps(v, _mm_or_ps(round, _mm_and_ps(v, sign))));
+        int32_t packed = _mm_cvtsi128_si32(_mm_packs_epi32(q, q));
+        memcpy(dst + i * 2, &packed, sizeof(packed));
+    }
+}
+
+template<bool Indexed>
+aiTargetSSE41 static void aiQuantizeUVsUNorm16SSE41(uint16_t *dst, const abcV2 *src, const int *indices, size_t num,
+    const abcV2 &bmin, const abcV2 &scale)
+{
+    const __m128 vmin = _mm_setr_ps(bmin.x, bmin.y, 0.0f, 0.0f);
+    const __m128 vscale = _mm_setr_ps(scale.x, scale.y, 0.0f, 0.0f);
+    const __m128 lo = _mm_setzero_ps();
+    const __m128 hi = _mm_set1_ps(65535.0f);
+    const __m128 round = _mm_set1_ps(0.5f);
+    for (size_t i = 0; i < num; ++i) {
+        __m128 v = _mm_castpd_ps(_mm_load_sd((const double*)&src[aiSourceIndex<Indexed>(indices, i)].x));
+        v = _mm_mul_ps(_mm_sub_ps(v, vmin), vscale);
+        v = _mm_min_ps(_mm_max_ps(v, lo), hi);
+        __m128i q = _mm_cvttps_epi32(_mm_add_ps(v, round));
+        int32_t packed = _mm_cvtsi128_si32(_mm_packus_epi32(q, q));
+        memcpy(dst + i * 2, &packed, sizeof(packed));
+    }
+}
+
+// 4 points (12 floats) per iteration. the lanes of the 3 loads hold x y z x, y z x y and z x y z
+aiTargetSSE41 static void aiComputeBoundsSSE41(const abcV3 *src, size_t num, abcV3 &o_min, abcV3 &o_max)
+{
+    size_t nb = num / 4;
+    if (nb > 0) {
+        const float *s = &src[0].x;
+        __m128 mn[3], mx[3];
+        for (int k = 0; k < 3; ++k) { mn[k] = mx[k] = _mm_loadu_ps(s + k * 4); }
+        for (size_t b = 1; b < nb; ++b) {
+            for (int k = 0; k < 3; ++k) {
+                __m128 v = _mm_loadu_ps(s + b * 12 + k * 4);
+                mn[k] = _mm_min_ps(mn[k], v);
+                mx[k] = _mm_max_ps(mx[k], v);
+            }
+        }
+        float fmn[12], fmx[12];
+        for (int k = 0; k < 3; ++k) {
+            _mm_storeu_ps(fmn + k * 4, mn[k]);
+            _mm_storeu_ps(fmx + k * 4, mx[k]);
+        }
+        // float j of the 12 belongs to component j % 3
+        for (int j = 0; j < 12; ++j) {
+            o_min[j % 3] = std::min<float>(o_min[j % 3], fmn[j]);
+            o_max[j % 3] = std::max<float>(o_max[j % 3], fmx[j]);
+        }
+    }
+    size_t done = nb * 4;
+    aiComputeBoundsScalar(src + done, num - done, o_min, o_max);
+}
+
+
+// AVX2
+
+// 8 points (24 floats) per iteration
+aiTargetAVX2 static void aiCopyPointsReverseXAVX2(abcV3 *dst, const abcV3 *src, size_t num)
+{
+    const float *s = &src[0].x;
+    float *d = &dst[0].x;
+    const int n = 0x80000000;
+    const __m256 m0 = _mm256_castsi256_ps(_mm256_setr_epi32(n, 0, 0, n, 0, 0, n, 0));
+    const __m256 m1 = _mm256_castsi256_ps(_mm256_setr_epi32(0, n, 0, 0, n, 0, 0, n));
+    const __m256 m2 = _mm256_castsi256_ps(_mm256_setr_epi32(0, 0, n, 0, 0, n, 0, 0));
+
+    size_t nb = num / 8;
+    for (size_t b = 0; b < nb; ++b) {
+        _mm256_storeu_ps(d +  0, _mm256_xor_ps(_mm256_loadu_ps(s +  0), m0));
+        _mm256_storeu_ps(d +  8, _mm256_xor_ps(_mm256_loadu_ps(s +  8), m1));
+        _mm256_storeu_ps(d + 16, _mm256_xor_ps(_mm256_loadu_ps(s + 16), m2));
+        s += 24;
+        d += 24;
+    }
+    aiCopyPointsScalar<true>(dst + nb * 8, src + nb * 8, num - nb * 8);
+}
+
+// gathers x, y and z of 8 points into separate registers, then transposes them back to xyz xyz ...
+template<bool ReverseX>
+aiTargetAVX2 static void aiGatherPointsAVX2(abcV3 *dst, const abcV3 *src, const int *indices, size_t num)
+{
+    const float *s = &src[0].x;
+    float *d = &dst[0].x;
+    const __m256i three = _mm256_set1_epi32(3);
+    const __m256 sign = _mm256_castsi256_ps(_mm256_set1_epi32(0x80000000));
+
+    size_t nb = num / 8;
+    for (size_t b = 0; b < nb; ++b) {
+        __m256i idx = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i*)(indices + b * 8)), three);
+        __m256 x = _mm256_i32gather_ps(s + 0, idx, 4);
+        __m256 y = _mm256_i32gather_ps(s + 1, idx, 4);
+        __m256 z = _mm256_i32gather_ps(s + 2, idx, 4);
+        if (ReverseX) { x = _mm256_xor_ps(x, sign); }
+
+        __m256 rxy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 ryz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));
+        __m256 rzx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256 r03 = _mm256_shuffle_ps(rxy, rzx, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 r14 = _mm256_shuffle_ps(ryz, rxy, _MM_SHUFFLE(3, 1, 2, 0));
+        __m256 r25 = _mm256_shuffle_ps(rzx, ryz, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm256_storeu_ps(d +  0, _mm256_permute2f128_ps(r03, r14, 0x20));
+        _mm256_storeu_ps(d +  8, _mm256_permute2f128_ps(r25, r03, 0x30));
+        _mm256_storeu_ps(d + 16, _mm256_permute2f128_ps(r14, r25, 0x31));
+        d += 24;
+    }
+    size_t done = nb * 8;
+    aiGatherPointsSSE41<ReverseX>(dst + done, src, indices + done, num - done);
+}
+
+// a point is 8 bytes, so 64 bit gathers fetch 4 of them at once
+aiTargetAVX2 static void aiGatherPointsAVX2(abcV2 *dst, const abcV2 *src, const int *indices, size_t num)
+{
+    const long long *s = (const long long*)src;
+    size_t nb = num / 4;
+    for (size_t b = 0; b < nb; ++b) {
+        __m128i idx = _mm_loadu_si128((const __m128i*)(indices + b * 4));
+        _mm256_storeu_si256((__m256i*)(dst + b * 4), _mm256_i32gather_epi64(s, idx, 8));
+    }
+    size_t done = nb * 4;
+    aiGatherPointsScalar(dst + done, src, indices + done, num - done);
+}
+
+aiTargetAVX2 static void aiCopyIndicesReverseAVX2(int *dst, const int *src, size_t num)
+{
+    const __m256i rev = _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0);
+    size_t nb = num / 8;
+    for (size_t b = 0; b < nb; ++b) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + num - (b + 1) * 8));
+        _mm256_storeu_si256((__m256i*)(dst + b * 8), _mm256_permutevar8x32_epi32(v, rev));
+    }
+    size_t done = nb * 8;
+    aiCopyIndicesReverseScalar(dst + done, src, num - done);
+}
+
+aiTargetAVX2 static void aiExtrapolateAVX2(float *dst, const float *p, const float *v, size_t num, float dt)
+{
+    const __m256 t = _mm256_set1_ps(dt);
+    size_t nb = num / 8;
+    for (size_t b = 0; b < nb; ++b) {
+        size_t i = b * 8;
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(_mm256_loadu_ps(p + i), _mm256_mul_ps(_mm256_loadu_ps(v + i), t)));
+    }
+    size_t done = nb * 8;
+    aiExtrapolateSSE41(dst + done, p + done, v + done, num - done, dt);
+}
+
+aiTargetAVX2 static void aiLerpAVX2(float *dst, const float *a, const float *b, size_t num, float t)
+{
+    const __m256 w = _mm256_set1_ps(t);
+    size_t nb = num / 8;
+    for (size_t bi = 0; bi < nb; ++bi) {
+        size_t i = bi * 8;
+        __m256 va = _mm256_loadu_ps(a + i);
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(va, _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(b + i), va), w)));
+    }
+    size_t done = nb * 8;
+    aiLerpSSE41(dst + done, a + done, b + done, num - done, t);
+}
+
+// 8 deltas to float
+aiTargetAVX2 static inline __m256 aiLoadDeltasAVX2(const int16_t *src)
+{
+    return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)src)));
+}
+
+aiTargetAVX2 static inline __m256 aiLoadDeltasAVX2(const int8_t *src)
+{
+    return _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i*)src)));
+}
+
+// 8 points (24 floats) per iteration
+template<class T>
+aiTargetAVX2 static void aiDecodeDeltaPointsAVX2(abcV3 *dst, const abcV3 *key, const T *deltas, size_t num, const abcV3 &step)
+{
+    const __m256 s0 = _mm256_setr_ps(step.x, step.y, step.z, step.x, step.y, step.z, step.x, step.y);
+    const __m256 s1 = _mm256_setr_ps(step.z, step.x, step.y, step.z, step.x, step.y, step.z, step.x);
+    const __m256 s2 = _mm256_setr_ps(step.y, step.z, step.x, step.y, step.z, step.x, step.y, step.z);
+    const float *k = &key[0].x;
+    float *d = &dst[0].x;
+
+    size_t nb = num / 8;
+    for (size_t b = 0; b < nb; ++b) {
+        size_t i = b * 24;
+        _mm256_storeu_ps(d + i +  0, _mm256_add_ps(_mm256_loadu_ps(k + i +  0), _mm256_mul_ps(aiLoadDeltasAVX2(deltas + i +  0), s0)));
+        _mm256_storeu_ps(d + i +  8, _mm256_add_ps(_mm256_loadu_ps(k + i +  8), _mm256_mul_ps(aiLoadDeltasAVX2(deltas + i +  8), s1)));
+        _mm256_storeu_ps(d + i + 16, _mm256_add_ps(_mm256_loadu_ps(k + i + 16), _mm256_mul_ps(aiLoadDeltasAVX2(deltas + i + 16), s2)));
+    }
+    size_t done = nb * 8;
+    aiDecodeDeltaPointsSSE41(dst + done, key + done, deltas + done * 3, num - done, step);
+}
+
+// F16C rounds to nearest even like half does
+template<bool Indexed>
+aiTargetAVX2 static void aiQuantizePointsHalfAVX2(uint16_t *dst, const abcV3 *src, const int *indices, size_t num, float x_sign)
+{
+    const __m128 xsign = aiXSignMaskSSE41(x_sign);
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (size_t i = 0; i < num; ++i) {
+        __m128 v = _mm_xor_ps(aiLoadPointSSE41(src[aiSourceIndex<Indexed>(indices, i)]), xsign);
+        v = _mm_insert_ps(v, one, 0x30);
+        _mm_storel_epi64((__m128i*)(dst + i * 4), _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+    }
+}
+
+
+static void aiCPUID(int info[4], int leaf, int subleaf)
+{
+#ifdef _MSC_VER
+    __cpuidex(info, leaf, subleaf);
+#else
+    unsigned int a = 0, b = 0, c = 0, d = 0;
+    __cpuid_count(leaf, subleaf, a, b, c, d);
+    info[0] = a; info[1] = b; info[2] = c; info[3] = d;
+#endif
+}
+
+static uint64_t aiXGetBV()
+{
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned int a = 0, d = 0;
+    __asm__ __volatile__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (uint64_t(d) << 32) | a;
+#endif
+}
+
+#endif // aiSIMDX86
+
+
+static aiInstructionSet aiDetectInstructionSet()
+{
+#ifdef aiSIMDX86
+    int info[4];
+    aiCPUID(info, 0, 0);
+    int num_ids = info[0];
+    if (num_ids < 1) { return aiInstructionSet_Scalar; }
+
+    aiCPUID(info, 1, 0);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    bool f16c = (info[2] & (1 << 29)) != 0;
+    bool avx2 = false;
+    // the OS must save ymm registers too. the AVX2 kernels use F16C as well, which every AVX2 CPU has
+    if (num_ids >= 7 && osxsave && avx && f16c && (aiXGetBV() & 6) == 6) {
+        aiCPUID(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+
+    if (avx2) { return aiInstructionSet_AVX2; }
+    if (sse41) { return aiInstructionSet_SSE41; }
+#endif // aiSIMDX86
+    return aiInstructionSet_Scalar;
+}
+
+static const aiInstructionSet g_supported_isa = aiDetectInstructionSet();
+static aiInstructionSet g_isa = g_supported_isa;
+
+aiInstructionSet aiGetInstructionSet()
+{
+    return g_isa;
+}
+
+aiInstructionSet aiSetInstructionSet(aiInstructionSet v)
+{
+    g_isa = std::min<aiInstructionSet>(v, g_supported_isa);
+    return g_isa;
+}
+
+
+void aiCopyPoints(abcV3 *dst, const abcV3 *src, size_t num, bool reverse_x)
+{
+    if (!reverse_x) {
+        std::copy(src, src + num, dst);
+        return;
+    }
+    switch (g_isa) {
+#ifdef aiSIMDX86
+    case aiInstructionSet_AVX2:  aiCopyPointsReverseXAVX2(dst, src, num); break;
+    case aiInstructionSet_SSE41: aiCopyPointsReverseXSSE41(dst, src, num); break;
+#endif // aiSIMDX86
+    default: aiCopyPointsScalar<true>(dst, src, num); break;
+    }
+}
+
+void aiGatherPoints(abcV3 *dst, const abcV3 *src, const int *indices, size_t num, bool reverse_x)
+{
+    switch (g_isa) {
+#ifdef aiSIMDX86
+    case aiInstructionSet_AVX2:
+        if (reverse_x) { aiGatherPointsAVX2<true>(dst, src, indices, num); }
+        else           { aiGatherPointsAVX2<false>(dst, src, indices, num); }
+        break;
+    case aiInstructionSet_SSE41:
+        if (reverse_x) { aiGatherPointsSSE41<true>(dst, src, indices, num); }
+        else           { aiGatherPointsSSE41<false>(dst, src, indices, num); }
+        break;
+#endif // aiSIMDX86
+    default:
+        if (reverse_x) { aiGatherPointsScalar<true>(dst, src, indices, num); }
+        else           { aiGatherPointsScalar<false>(dst, src, indices, num); }
+        break;
+    }
+}
+
+void aiGatherPoints(abcV2 *dst, const abcV2 *src, const int *indices, size_t num)
+{
+    switch (g_isa) {
+#ifdef aiSIMDX86
+    case aiInstructionSet_AVX2:  aiGatherPointsAVX2(dst, src, indices, num); break;
+    case aiInstructionSet_SSE41: aiGatherPointsSSE41(dst, src, indices, num); break;
+#endif // aiSIMDX86
+    default: aiGatherPointsScalar(dst, src, indices, num); break;
+    }
+}
+
+void aiCopyIndices(int *dst, const int *src, size_t num, bool reverse)
+{
+    if (!reverse) {
+        memcpy(dst, src, sizeof(int) * num);
+        return;
+    }
+    switch (g_isa) {
+#ifdef aiSIMDX86
+    case aiInstructionSet_AVX2:  aiCopyIndicesReverseAVX2(dst, src, num); break;
+    case aiInstructionSet_SSE41: aiCopyIndicesReverseSSE41(dst, src, num); break;
+#endif // aiSIMDX86
+    default: aiCopyIndicesReverseScalar(dst, src, num); break;
+    }
+}
+
+void aiExtrapolatePoints(abcV3 *dst, const abcV3 *positions, const abcV3 *velocities, size_t num, float dt)
+{
+    float *d = &dst[0].x;
+    const float *p = &positions[0].x;
+    const float *v = &velocities[0].x;
+    switch (g_isa) {
+#ifdef aiSIMDX86
+    case aiInstructionSet_AVX2:  aiExtrapolateAVX2(d, p, v, num * 3, dt); break;
+    case aiInstructionSet_SSE41: aiExtrapolateSSE41(d, p, v, num * 3, dt); break;
+#endif // aiSIMDX86
+    default: aiExtrapolateScalar(d, p, v, num * 3, dt); break;
+    }
+}
+
+void aiLerpPoints(abcV3 *dst, const abcV3 *a, const abcV3 *b, size_t num, float t)
+{
+    float *d = &dst[0].x;
+    switch (g_isa) {
+#ifdef aiSIMDX86
+    case aiInstructionSet_AVX2:  aiLerpAVX2(d, &a[0].x, &b[0].x, num * 3, t); break;
+    case aiInstructionSet_SSE41: aiLerpSSE41(d, &a[0].x, &b[0].x, num * 3, t); break;
+#endif // aiSIMDX86
+    default: aiLerpScalar(d, &a[0].x, &b[0].x, num * 3, t); break;
+    }
+}
+
+void aiExpandPoints(abcV4 *dst, const abcV3 *src, size_t num, float w, bool reverse_x)
+{
+    switch (g_isa) {
+#ifdef aiSIMDX86
+    case aiInstructionSet_AVX2:
+    case aiInstructionSet_SSE41:
+        if (reverse_x) { aiExpandPointsSSE41<true>(dst, src, num, w); }
+        else           { aiExpandPointsSSE41<false>(dst, src, num, w); }
+        break;
+#endif // aiSIMDX86
+    default:
+        if (reverse_x) { aiExpandPointsScalar<true>(dst, src, num, w); }
+        else           { aiExpandPointsScalar<false>(dst, src, num, w); }
+        break;
+    }
+}
+
+template<class T>
+static void aiDecodeDeltaPointsImpl(abcV3 *dst, const abcV3 *key, const T *deltas, size_t num, const abcV3 &step)
+{
+    switch (g_isa) {
+#ifdef aiSIMDX86
+    case aiInstructionSet_AVX2:  aiDecodeDeltaPointsAVX2(dst, key, deltas, num, step); break;
+    case aiInstructionSet_SSE41: aiDecodeDeltaPointsSSE41(dst, key, deltas, num, step); break;
+#endif // aiSIMDX86
+    default: aiDecodeDeltaPointsScalar(dst, key, deltas, num, step); break;
+    }
+}
+
+void aiDecodeDeltaPoints(abcV3 *dst, const abcV3 *key, const int16_t *deltas, size_t num, const abcV3 &step)
+{
+    aiDecodeDeltaPointsImpl(dst, key, deltas, num, step);
+}
+
+void aiDecodeDeltaPoints(abcV3 *dst, const abcV3 *key, const int8_t *deltas, size_t num, const abcV3 &step)
+{
+    aiDecodeDeltaPointsImpl(dst, key, deltas, num, step);
+}
+
+void aiQuantizePointsUNorm16(uint16_t *dst, const abcV3 *src, const int *indices, size_t num,
+    const abcV3 &bmin, const abcV3 &scale, bool reverse_x)
+{
+    float x_sign = reverse_x ? -1.0f : 1.0f;
+    switch (g_isa) {
+#ifdef aiSIMDX86
+    case aiInstructionSet_AVX2:
+    case aiInstructionSet_SSE41:
+        if (indices) { aiQuantizePointsUNorm16SSE41<true>(dst, src, indices, num, bmin, scale, x_sign); }
+        else         { aiQuantizePointsUNorm16SSE41<false>(dst, src, indices, num, bmin, scale, x_sign); }
+        break;
+#endif // aiSIMDX86
+    default:
+        if (indices) { aiQuantizePointsUNorm16Scalar<true>(dst, src, indices, num, bmin, scale, x_sign); }
+        else         { aiQuantizePointsUNorm16Scalar<false>(dst, src, indices, num, bmin, scale, x_sign); }
+        break;
+    }
+}
+
+void aiQuantizePointsHalf(uint16_t *dst, const abcV3 *src, const int *indices, size_t num, bool reverse_x)
+{
+    float x_sign = reverse_x ? -1.0f : 1.0f;
+    switch (g_isa) {
+#ifdef aiSIMDX86
+    case aiInstructionSet_AVX2:
+        if (indices) { aiQuantizePointsHalfAVX2<true>(dst, src, indices, num, x_sign); }
+        else         { aiQuantizePointsHalfAVX2<false>(dst, src, indices, num, x_sign); }
+        break;
+#endif // aiSIMDX86
+    // no conversion instruction below F16C
+    default:
+        if (indices) { aiQuantizePointsHalfScalar<true>(dst, src, indices, num, x_sign); }
+        else         { aiQuantizePointsHalfScalar<false>(dst, src, indices, num, x_sign); }
+        break;
+    }
+}
+
+void aiQuantizeNormalsOct16(int16_t *dst, const abcV3 *src, const int *indices, size_t num, bool reverse_x)
+{
+    float x_sign = reverse_x ? -1.0f : 1.0f;
+    switch (g_isa) {
+#ifdef aiSIMDX86
+    case aiInstructionSet_AVX2:
+    case aiInstructionSet_SSE41:
+        if (indices) { aiQuantizeNormalsOct16SSE41<true>(dst, src, indices, num, x_sign); }
+        else         { aiQuantizeNormalsOct16SSE41<false>(dst, src, indices, num, x_sign); }
+        break;
+#endif // aiSIMDX86
+    default:
+        if (indices) { aiQuantizeNormalsOct16Scalar<true>(dst, src, indices, num, x_sign); }
+        else         { aiQuantizeNormalsOct16Scalar<false>(dst, src, indices, num, x_sign); }
+        break;
+    }
+}
+
+void aiQuantizeUVsUNorm16(uint16_t *dst, const abcV2 *src, const int *indices, size_t num, const abcV2 &bmin, const abcV2 &scale)
+{
+    switch (g_isa) {
+#ifdef aiSIMDX86
+    case aiInstructionSet_AVX2:
+    case aiInstructionSet_SSE41:
+        if (indices) { aiQuantizeUVsUNorm16SSE41<true>(dst, src, indices, num, bmin, scale); }
+        else         { aiQuantizeUVsUNorm16SSE41<false>(dst, src, indices, num, bmin, scale); }
+        break;
+#endif // aiSIMDX86
+    default:
+        if (indices) { aiQuantizeUVsUNorm16Scalar<true>(dst, src, indices, num, bmin, scale); }
+        else         { aiQuantizeUVsUNorm16Scalar<false>(dst, src, indices, num, bmin, scale); }
+        break;
+    }
+}
+
+void aiComputeBounds(const abcV3 *src, size_t num, abcV3 &io_min, abcV3 &io_max)
+{
+    switch (g_isa) {
+#ifdef aiSIMDX86
+    case aiInstructionSet_AVX2:
+    case aiInstructionSet_SSE41: aiComputeBoundsSSE41(src, num, io_min, io_max); break;
+#endif // aiSIMDX86
+    default: aiComputeBoundsScalar(src, num, io_min, io_max); break;
+    }
+}
+
+void aiComputeBounds(const abcV2 *src, size_t num, abcV2 &io_min, abcV2 &io_max)
+{
+    aiComputeBoundsScalar(src, num, io_min, io_max);
+}
@@ -0,0 +1,51 @@
+#ifndef aiSIMD_h
+#define aiSIMD_h
+
+// vectorized copy / gather kernels for mesh attributes.
+// the instruction set is detected once at load time. every kernel branches on it and on its flags once per call,
+// the inner loops are branch free.
+
+enum aiInstructionSet
+{
+    aiInstructionSet_Scalar,
+    aiInstructionSet_SSE41,
+    aiInstructionSet_AVX2,
+};
+
+aiInstructionSet aiGetInstructionSet();
+// for testing and benchmarking. can't go above what the CPU supports. returns the instruction set actually set
+aiInstructionSet aiSetInstructionSet(aiInstructionSet v);
+
+// dst[i] = src[i], x negated if reverse_x
+void aiCopyPoints(abcV3 *dst, const abcV3 *src, size_t num, bool reverse_x);
+// dst[i] = src[indices[i]], x negated if reverse_x. indices must be in range of src
+void aiGatherPoints(abcV3 *dst, const abcV3 *src, const int *indices, size_t num, bool reverse_x);
+void aiGatherPoints(abcV2 *dst, const abcV2 *src, const int *indices, size_t num);
+// dst[i] = src[num - i - 1] if reverse, else dst[i] = src[i]
+void aiCopyIndices(int *dst, const int *src, size_t num, bool reverse);
+// dst[i] = positions[i] + velocities[i] * dt
+void aiExtrapolatePoints(abcV3 *dst, const abcV3 *positions, const abcV3 *velocities, size_t num, float dt);
+// dst[i] = a[i] + (b[i] - a[i]) * t
+void aiLerpPoints(abcV3 *dst, const abcV3 *a, const abcV3 *b, size_t num, float t);
+// dst[i] = (src[i], w), x negated if reverse_x. for float4 textures
+void aiExpandPoints(abcV4 *dst, const abcV3 *src, size_t num, float w, bool reverse_x);
+// dst[i] = key[i] + (deltas[i * 3], deltas[i * 3 + 1], deltas[i * 3 + 2]) * step. every instruction set gives the same bits
+void aiDecodeDeltaPoints(abcV3 *dst, const abcV3 *key, const int16_t *deltas, size_t num, const abcV3 &step);
+void aiDecodeDeltaPoints(abcV3 *dst, const abcV3 *key, const int8_t *deltas, size_t num, const abcV3 &step);
+
+// quantizers for the compact aiVertexFormat encodings. element i is made from src[indices[i]], or src[i] if indices
+// is null, with x negated first if reverse_x. every instruction set gives the same bits
+// 4 unorm16 per point: (p - bmin) * scale rounded and clamped to [0, 65535]. w = 65535
+void aiQuantizePointsUNorm16(uint16_t *dst, const abcV3 *src, const int *indices, size_t num,
+    const abcV3 &bmin, const abcV3 &scale, bool reverse_x);
+// 4 half floats per point, rounded to nearest even. w = 1
+void aiQuantizePointsHalf(uint16_t *dst, const abcV3 *src, const int *indices, size_t num, bool reverse_x);
+// 2 snorm16 per normal, octahedral. src doesn't need to be normalized
+void aiQuantizeNormalsOct16(int16_t *dst, const abcV3 *src, const int *indices, size_t num, bool reverse_x);
+// 2 unorm16 per uv, like aiQuantizePointsUNorm16()
+void aiQuantizeUVsUNorm16(uint16_t *dst, const abcV2 *src, const int *indices, size_t num, const abcV2 &bmin, const abcV2 &scale);
+// grows io_min / io_max to contain src
+void aiComputeBounds(const abcV3 *src, size_t num, abcV3 &io_min, abcV3 &io_max);
+void aiComputeBounds(const abcV2 *src, size_t num, abcV2 &io_min, abcV2 &io_max);
+
+#endif // aiSIMD_h
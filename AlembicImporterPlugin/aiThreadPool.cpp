@@ -54,6 +54,11 @@ aiThreadPool& aiThreadPool::getInstance()
     return s_instance;
 }
 
+size_t aiThreadPool::getNumWorkers() const
+{
+    return m_workers.size();
+}
+
 void aiThreadPool::enqueue(const std::function<void()> &f)
 {
     {
@@ -65,8 +70,30 @@ void aiThreadPool::enqueue(const std::function<void()> &f)
 
 
 
+void aiTaskQueue::push(const std::function<void()> &f)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_tasks.push_back(f);
+}
+
+bool aiTaskQueue::runOne()
+{
+    std::function<void()> task;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_tasks.empty()) { return false; }
+        task = m_tasks.front();
+        m_tasks.pop_front();
+    }
+    task();
+    return true;
+}
+
+
+
 aiTaskGroup::aiTaskGroup()
     : m_active_tasks(0)
+    , m_queue(new aiTaskQueue())
 {
 }
 
@@ -74,21 +101,27 @@ aiTaskGroup::~aiTaskGroup()
 {
 }
 
+// tasks of other groups, like prefetch reads, are left to the workers. they could take much longer than the
+// tasks waited for
 void aiTaskGroup::wait()
 {
-    aiThreadPool &pool = aiThreadPool::getInstance();
     while (m_active_tasks > 0)
     {
-        std::function<void()> task;
-        {
-            std::unique_lock<std::mutex> lock(pool.m_queue_mutex);
-            if (!pool.m_tasks.empty()) {
-                task = pool.m_tasks.front();
-                pool.m_tasks.pop_front();
-            }
+        if (!m_queue->runOne()) {
+            // the rest is running on workers
+            std::this_thread::yield();
         }
-        if (task) { task(); }
     }
 }
 
 #endif // aiWithTBB
+
+
+size_t aiGetNumTaskThreads()
+{
+#ifndef aiWithTBB
+    return aiThreadPool::getInstance().getNumWorkers() + 1;
+#else // aiWithTBB
+    return tbb::task_scheduler_init::default_num_threads();
+#endif // aiWithTBB
+}
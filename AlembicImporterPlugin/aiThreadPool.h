@@ -12,16 +12,17 @@
 
 class aiWorkerThread;
 class aiThreadPool;
+class aiTaskQueue;
 class aiTaskGroup;
 
 
 class aiThreadPool
 {
 friend class aiWorkerThread;
-friend class aiTaskGroup;
 public:
     static aiThreadPool& getInstance();
     void enqueue(const std::function<void()> &f);
+    size_t getNumWorkers() const;
 
 private:
     aiThreadPool(size_t);
@@ -37,26 +38,46 @@ private:
 
 
 
+// tasks of one aiTaskGroup that are not started yet. the pool holds one entry per task that runs the next one
+// of the queue, so that a waiting thread can run tasks of its own group and leave those of others alone.
+class aiTaskQueue
+{
+public:
+    void push(const std::function<void()> &f);
+    // returns false if there was no task left
+    bool runOne();
+
+private:
+    std::mutex m_mutex;
+    std::deque< std::function<void()> > m_tasks;
+};
+typedef std::shared_ptr<aiTaskQueue> aiTaskQueuePtr;
+
+
 class aiTaskGroup
 {
 public:
     aiTaskGroup();
     ~aiTaskGroup();
     template<class F> void run(const F &f);
+    // runs tasks of this group on the calling thread until all of them are done
     void wait();
 
 private:
     std::atomic<int> m_active_tasks;
+    aiTaskQueuePtr m_queue; // outlives the group in the entries of the pool
 };
 
 template<class F>
 void aiTaskGroup::run(const F &f)
 {
     ++m_active_tasks;
-    aiThreadPool::getInstance().enqueue([this, f](){
+    m_queue->push([this, f](){
         f();
         --m_active_tasks;
     });
+    aiTaskQueuePtr queue = m_queue;
+    aiThreadPool::getInstance().enqueue([queue](){ queue->runOne(); });
 }
 
 #else // aiWithTBB
@@ -66,4 +87,30 @@ typedef tbb::task_group aiTaskGroup;
 
 #endif // aiWithTBB
 
+// number of threads that can run tasks concurrently (workers + the waiting thread)
+size_t aiGetNumTaskThreads();
+
+// splits [begin, end) into at most aiGetNumTaskThreads() ranges of at least grain elements and calls
+// f(range_begin, range_end) for each of them concurrently. the calling thread takes the first range.
+template<class F>
+inline void aiParallelFor(size_t begin, size_t end, size_t grain, const F &f)
+{
+    if (end <= begin) { return; }
+    size_t n = end - begin;
+    size_t num_ranges = std::min<size_t>(aiGetNumTaskThreads(), std::max<size_t>(n / std::max<size_t>(grain, 1), 1));
+    if (num_ranges <= 1) {
+        f(begin, end);
+        return;
+    }
+
+    size_t step = (n + num_ranges - 1) / num_ranges;
+    aiTaskGroup tasks;
+    for (size_t b = begin + step; b < end; b += step) {
+        size_t e = std::min<size_t>(b + step, end);
+        tasks.run([&f, b, e](){ f(b, e); });
+    }
+    f(begin, begin + step);
+    tasks.wait();
+}
+
 #endif // aiThreadPool_h
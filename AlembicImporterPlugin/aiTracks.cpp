@@ -0,0 +1,71 @@
+﻿#include "pch.h"
+#include "AlembicImporter.h"
+#include "aiTracks.h"
+
+// same tolerance as TimeSampling
+static const double aiTimeEpsilon = 1e-5;
+
+aiTrackTimes::aiTrackTimes(const AbcCoreAbstract::TimeSampling &ts, size_t num_samples)
+    : m_start(0.0), m_step(0.0), m_num_samples(num_samples)
+{
+    if (num_samples == 0) { return; }
+    m_start = ts.getSampleTime(0);
+    if (ts.getTimeSamplingType().isUniform()) {
+        m_step = ts.getTimeSamplingType().getTimePerCycle();
+    }
+    else {
+        m_times.resize(num_samples);
+        for (size_t i = 0; i < num_samples; ++i) {
+            m_times[i] = ts.getSampleTime(i);
+        }
+    }
+}
+
+double aiTrackTimes::getTime(size_t index) const
+{
+    return m_times.empty() ? m_start + m_step * index : m_times[index];
+}
+
+size_t aiTrackTimes::getFloorIndex(double time) const
+{
+    if (m_num_samples == 0 || time <= m_start) { return 0; }
+    size_t last = m_num_samples - 1;
+    if (time >= getTime(last)) { return last; }
+
+    size_t index;
+    if (m_times.empty()) {
+        index = std::min<size_t>((size_t)((time - m_start) / m_step), last);
+        // roundoff may land on either side of a sample time
+        if (getTime(index) > time && index > 0 && std::abs(time - getTime(index)) > aiTimeEpsilon) {
+            --index;
+        }
+        else if (index < last && std::abs(time - getTime(index + 1)) <= aiTimeEpsilon) {
+            ++index;
+        }
+    }
+    else {
+        index = std::upper_bound(m_times.begin(), m_times.end(), time) - m_times.begin() - 1;
+        if (index < last && std::abs(time - m_times[index + 1]) <= aiTimeEpsilon) {
+            ++index;
+        }
+    }
+    return index;
+}
+
+size_t aiTrackTimes::getCeilIndex(double time) const
+{
+    size_t index = getFloorIndex(time);
+    if (index + 1 >= m_num_samples || time <= m_start || std::abs(time - getTime(index)) <= aiTimeEpsilon) {
+        return index;
+    }
+    return index + 1;
+}
+
+size_t aiTrackTimes::getNearIndex(double time) const
+{
+    size_t index = getFloorIndex(time);
+    if (index + 1 >= m_num_samples) {
+        return index;
+    }
+    return std::abs(time - getTime(index)) <= std::abs(getTime(index + 1) - time) ? index : index + 1;
+}
@@ -0,0 +1,37 @@
+﻿#ifndef aiTracks_h
+#define aiTracks_h
+
+// sample times of a property, to look its samples up without going through Alembic. same indices as
+// Abc::ISampleSelector. uniform samplings are looked up arithmetically, the others by binary search
+class aiTrackTimes
+{
+public:
+    aiTrackTimes(const AbcCoreAbstract::TimeSampling &ts, size_t num_samples);
+
+    size_t      getNumSamples() const { return m_num_samples; }
+    double      getTime(size_t index) const;
+    size_t      getFloorIndex(double time) const;
+    size_t      getCeilIndex(double time) const;
+    size_t      getNearIndex(double time) const;
+
+private:
+    std::vector<double> m_times;    // of all samples. empty if uniform
+    double m_start;
+    double m_step;
+    size_t m_num_samples;
+};
+typedef std::shared_ptr<const aiTrackTimes> aiTrackTimesPtr;
+
+// the samples of a property over the whole time range, by sample index
+template<class T>
+struct aiTrack
+{
+    aiTrackTimesPtr times;
+    std::vector<T> samples;
+
+    bool valid() const { return !samples.empty(); }
+    // by ISampleSelector's kNearIndex
+    const T& getNear(float time) const { return samples[times->getNearIndex(time)]; }
+};
+
+#endif // aiTracks_h
@@ -111,7 +111,35 @@ void AprImpl::getSample( index_t iSampleIndex, AbcA::ArraySamplePtr &oSample )
     Ogawa::IDataPtr dims = m_group->getData(index + 1, id);
     Ogawa::IDataPtr data = m_group->getData(index, id);
 
-    ReadArraySample( dims, data, id, m_header->header.getDataType(), oSample );
+    const AbcA::DataType & dataType = m_header->header.getDataType();
+    AbcA::ReadArraySampleCachePtr cachePtr =
+        getObject()->getArchive()->getReadArraySampleCachePtr();
+
+    // strings aren't stored contiguously in an ArraySample, so they aren't
+    // cached, neither are empty samples since they all share the same key
+    if ( !cachePtr || !data || data->getSize() <= 16 ||
+         dataType.getPod() == Util::kStringPOD ||
+         dataType.getPod() == Util::kWstringPOD )
+    {
+        ReadArraySample( dims, data, id, dataType, oSample );
+        return;
+    }
+
+    AbcA::ArraySampleKey key;
+    key.readPOD = dataType.getPod();
+    key.origPOD = key.readPOD;
+    key.numBytes = data->getSize() - 16;
+    data->read( 16, key.digest.d, 0, id );
+
+    AbcA::ReadArraySampleID foundID = cachePtr->find( key );
+    if ( foundID && foundID.getSample()->getDataType() == dataType )
+    {
+        oSample = foundID.getSample();
+        return;
+    }
+
+    ReadArraySample( dims, data, id, dataType, oSample );
+    cachePtr->store( key, oSample );
 }
 
 //-*****************************************************************************
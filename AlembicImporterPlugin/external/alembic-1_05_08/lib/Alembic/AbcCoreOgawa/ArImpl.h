@@ -56,7 +56,8 @@ private:
     friend class ReadArchive;
 
     ArImpl( const std::string &iFileName,
-            size_t iNumStreams=1 );
+            size_t iNumStreams=1,
+            bool iUseMMap=false );
 
     ArImpl( const std::vector< std::istream * > & iStreams );
 
@@ -79,12 +80,15 @@ public:
 
     virtual AbcA::ReadArraySampleCachePtr getReadArraySampleCachePtr()
     {
-        return AbcA::ReadArraySampleCachePtr();
+        return m_cachePtr;
     }
 
+    // Should be set before any samples are read, the pointer itself is not
+    // guarded but the cache is expected to be thread safe (see CacheImpl)
     virtual void
     setReadArraySampleCachePtr( AbcA::ReadArraySampleCachePtr iPtr )
     {
+        m_cachePtr = iPtr;
     }
 
     virtual AbcA::index_t getMaxNumSamplesForTimeSamplingIndex(
@@ -126,6 +130,8 @@ private:
     StreamManager m_manager;
 
     std::vector< AbcA::MetaData > m_indexMetaData;
+
+    AbcA::ReadArraySampleCachePtr m_cachePtr;
 };
 
 } // End namespace ALEMBIC_VERSION_NS
@@ -0,0 +1,143 @@
+//-*****************************************************************************
+//
+// Copyright (c) 2013,
+//  Sony Pictures Imageworks Inc. and
+//  Industrial Light & Magic, a division of Lucasfilm Entertainment Company Ltd.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// *       Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// *       Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+// *       Neither the name of Sony Pictures Imageworks, nor
+// Industrial Light & Magic, nor the names of their contributors may be used
+// to endorse or promote products derived from this software without specific
+// prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//-*****************************************************************************
+
+#include <Alembic/AbcCoreOgawa/CacheImpl.h>
+
+namespace Alembic {
+namespace AbcCoreOgawa {
+namespace ALEMBIC_VERSION_NS {
+
+//-*****************************************************************************
+CacheImpl::CacheImpl( Alembic::Util::uint64_t iMaxBytes )
+  : m_maxBytes( iMaxBytes )
+  , m_numBytes( 0 )
+{
+}
+
+//-*****************************************************************************
+CacheImpl::~CacheImpl()
+{
+}
+
+//-*****************************************************************************
+AbcA::ReadArraySampleID
+CacheImpl::find( const AbcA::ArraySample::Key &iKey )
+{
+    Alembic::Util::scoped_lock l( m_lock );
+
+    Map::iterator foundIter = m_records.find( iKey );
+    if ( foundIter == m_records.end() )
+    {
+        return AbcA::ReadArraySampleID();
+    }
+
+    // move to the front of the list
+    Record & record = foundIter->second;
+    m_recentKeys.splice( m_recentKeys.begin(), m_recentKeys,
+                         record.keyIter );
+
+    return AbcA::ReadArraySampleID( iKey, record.sample );
+}
+
+//-*****************************************************************************
+AbcA::ReadArraySampleID
+CacheImpl::store( const AbcA::ArraySample::Key &iKey,
+                  AbcA::ArraySamplePtr iSamp )
+{
+    ABCA_ASSERT( iSamp, "Cannot store a null sample" );
+
+    Alembic::Util::uint64_t numBytes =
+        iSamp->getDimensions().numPoints() *
+        iSamp->getDataType().getNumBytes();
+
+    // too big to ever fit, don't bother
+    if ( numBytes > m_maxBytes )
+    {
+        return AbcA::ReadArraySampleID( iKey, iSamp );
+    }
+
+    Alembic::Util::scoped_lock l( m_lock );
+
+    // another thread may have read the same sample in the meantime
+    Map::iterator foundIter = m_records.find( iKey );
+    if ( foundIter != m_records.end() )
+    {
+        Record & record = foundIter->second;
+        m_recentKeys.splice( m_recentKeys.begin(), m_recentKeys,
+                             record.keyIter );
+        return AbcA::ReadArraySampleID( iKey, record.sample );
+    }
+
+    m_recentKeys.push_front( iKey );
+
+    Record & record = m_records[iKey];
+    record.sample = iSamp;
+    record.numBytes = numBytes;
+    record.keyIter = m_recentKeys.begin();
+    m_numBytes += numBytes;
+
+    evict();
+
+    return AbcA::ReadArraySampleID( iKey, iSamp );
+}
+
+//-*****************************************************************************
+Alembic::Util::uint64_t CacheImpl::getNumBytes()
+{
+    Alembic::Util::scoped_lock l( m_lock );
+    return m_numBytes;
+}
+
+//-*****************************************************************************
+// m_lock must be held
+void CacheImpl::evict()
+{
+    while ( m_numBytes > m_maxBytes && !m_recentKeys.empty() )
+    {
+        Map::iterator foundIter = m_records.find( m_recentKeys.back() );
+        m_recentKeys.pop_back();
+
+        if ( foundIter != m_records.end() )
+        {
+            m_numBytes -= foundIter->second.numBytes;
+            m_records.erase( foundIter );
+        }
+    }
+}
+
+} // End namespace ALEMBIC_VERSION_NS
+} // End namespace AbcCoreOgawa
+} // End namespace Alembic
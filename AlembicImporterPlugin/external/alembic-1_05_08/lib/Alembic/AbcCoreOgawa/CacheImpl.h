@@ -0,0 +1,105 @@
+//-*****************************************************************************
+//
+// Copyright (c) 2013,
+//  Sony Pictures Imageworks Inc. and
+//  Industrial Light & Magic, a division of Lucasfilm Entertainment Company Ltd.
+//
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+// *       Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+// *       Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+// *       Neither the name of Sony Pictures Imageworks, nor
+// Industrial Light & Magic, nor the names of their contributors may be used
+// to endorse or promote products derived from this software without specific
+// prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//-*****************************************************************************
+
+#ifndef _Alembic_AbcCoreOgawa_CacheImpl_h_
+#define _Alembic_AbcCoreOgawa_CacheImpl_h_
+
+#include <Alembic/AbcCoreOgawa/Foundation.h>
+
+#include <list>
+
+namespace Alembic {
+namespace AbcCoreOgawa {
+namespace ALEMBIC_VERSION_NS {
+
+//-*****************************************************************************
+//! Array samples keyed by the digest Ogawa stores with every array sample.
+//! Identical arrays (even on different properties or objects) are held once.
+//! The least recently used samples are dropped from the cache once the total
+//! size of the cached samples exceeds iMaxBytes, a dropped sample stays alive
+//! for as long as a reader holds on to it.
+//! This class is multithread safe.
+class CacheImpl : public AbcA::ReadArraySampleCache
+{
+public:
+    CacheImpl( Alembic::Util::uint64_t iMaxBytes );
+
+    virtual ~CacheImpl();
+
+    virtual AbcA::ReadArraySampleID
+    find( const AbcA::ArraySample::Key &iKey );
+
+    virtual AbcA::ReadArraySampleID
+    store( const AbcA::ArraySample::Key &iKey,
+           AbcA::ArraySamplePtr iSamp );
+
+    Alembic::Util::uint64_t getMaxBytes() const { return m_maxBytes; }
+    Alembic::Util::uint64_t getNumBytes();
+
+private:
+    typedef std::list< AbcA::ArraySample::Key > KeyList;
+
+    struct Record
+    {
+        AbcA::ArraySamplePtr sample;
+        Alembic::Util::uint64_t numBytes;
+
+        // position in m_recentKeys
+        KeyList::iterator keyIter;
+    };
+
+    typedef AbcA::UnorderedMapUtil<Record>::umap_type Map;
+
+    void evict();
+
+    Alembic::Util::mutex m_lock;
+    Map m_records;
+
+    // most recently used first
+    KeyList m_recentKeys;
+
+    Alembic::Util::uint64_t m_maxBytes;
+    Alembic::Util::uint64_t m_numBytes;
+};
+
+} // End namespace ALEMBIC_VERSION_NS
+
+using namespace ALEMBIC_VERSION_NS;
+
+} // End namespace AbcCoreOgawa
+} // End namespace Alembic
+
+#endif
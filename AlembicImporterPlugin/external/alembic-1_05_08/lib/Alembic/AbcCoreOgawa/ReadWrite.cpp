@@ -38,6 +38,7 @@
 #include <Alembic/AbcCoreOgawa/Foundation.h>
 #include <Alembic/AbcCoreOgawa/AwImpl.h>
 #include <Alembic/AbcCoreOgawa/ArImpl.h>
+#include <Alembic/AbcCoreOgawa/CacheImpl.h>
 
 namespace Alembic {
 namespace AbcCoreOgawa {
@@ -72,17 +73,26 @@ WriteArchive::operator()( std::ostream * iStream,
 ReadArchive::ReadArchive()
 {
     m_numStreams = 1;
+    m_useMMap = false;
 }
 
 //-*****************************************************************************
 ReadArchive::ReadArchive( size_t iNumStreams )
 {
     m_numStreams = iNumStreams;
+    m_useMMap = false;
+}
+
+//-*****************************************************************************
+ReadArchive::ReadArchive( size_t iNumStreams, bool iUseMMap )
+{
+    m_numStreams = iNumStreams;
+    m_useMMap = iUseMMap;
 }
 
 //-*****************************************************************************
 ReadArchive::ReadArchive( const std::vector< std::istream * > & iStreams )
-    : m_numStreams( 1 ), m_streams( iStreams )
+    : m_numStreams( 1 ), m_useMMap( false ), m_streams( iStreams )
 {
 }
 
@@ -95,7 +105,7 @@ ReadArchive::operator()( const std::string &iFileName ) const
     if ( m_streams.empty() )
     {
         archivePtr = Alembic::Util::shared_ptr<ArImpl>(
-            new ArImpl( iFileName, m_numStreams ) );
+            new ArImpl( iFileName, m_numStreams, m_useMMap ) );
     }
     else
     {
@@ -106,7 +116,6 @@ ReadArchive::operator()( const std::string &iFileName ) const
 }
 
 //-*****************************************************************************
-// The given cache is ignored.
 AbcA::ArchiveReaderPtr
 ReadArchive::operator()( const std::string &iFileName,
             AbcA::ReadArraySampleCachePtr iCache ) const
@@ -116,16 +125,24 @@ ReadArchive::operator()( const std::string &iFileName,
     if ( m_streams.empty() )
     {
         archivePtr = Alembic::Util::shared_ptr<ArImpl> (
-            new ArImpl( iFileName, m_numStreams ) );
+            new ArImpl( iFileName, m_numStreams, m_useMMap ) );
     }
     else
     {
         archivePtr = Alembic::Util::shared_ptr<ArImpl> (
             new ArImpl( m_streams ) );
     }
+    archivePtr->setReadArraySampleCachePtr( iCache );
     return archivePtr;
 }
 
+//-*****************************************************************************
+AbcA::ReadArraySampleCachePtr CreateCache( Alembic::Util::uint64_t iMaxBytes )
+{
+    AbcA::ReadArraySampleCachePtr cachePtr( new CacheImpl( iMaxBytes ) );
+    return cachePtr;
+}
+
 } // End namespace ALEMBIC_VERSION_NS
 } // End namespace AbcCoreOgawa
 } // End namespace Alembic
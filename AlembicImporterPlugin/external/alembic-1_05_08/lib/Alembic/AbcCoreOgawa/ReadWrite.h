@@ -70,6 +70,10 @@ public:
     // Open the file iNumStreams times and manage them internally
     ReadArchive( size_t iNumStreams );
 
+    // Same as above, but if iUseMMap is true map the file into memory and
+    // read from the mapping instead (falls back to the streams on failure)
+    ReadArchive( size_t iNumStreams, bool iUseMMap );
+
     // Read from the provided streams, we do not own these, expect them
     // to remain open and all have the same data in them, and do not try to
     // delete them
@@ -79,7 +83,9 @@ public:
     ::Alembic::AbcCoreAbstract::ArchiveReaderPtr
     operator()( const std::string &iFileName ) const;
 
-    // The given cache is ignored.
+    // open the file and read array samples through the given cache, which
+    // must be thread safe if the archive is read from multiple threads
+    // (see CreateCache), a null cache disables caching
     ::Alembic::AbcCoreAbstract::ArchiveReaderPtr
     operator()( const std::string &iFileName,
                 ::Alembic::AbcCoreAbstract::ReadArraySampleCachePtr iCache
@@ -87,9 +93,17 @@ public:
 
 private:
     size_t m_numStreams;
+    bool m_useMMap;
     std::vector< std::istream * > m_streams;
 };
 
+//-*****************************************************************************
+//! Creates a thread safe array sample cache which holds on to at most
+//! iMaxBytes worth of samples, samples are shared by their digest so that
+//! identical data is only read and stored once.
+::Alembic::AbcCoreAbstract::ReadArraySampleCachePtr
+CreateCache( ::Alembic::Util::uint64_t iMaxBytes );
+
 } // End namespace ALEMBIC_VERSION_NS
 
 using namespace ALEMBIC_VERSION_NS;
@@ -36,10 +36,51 @@
 
 #include <Alembic/AbcCoreOgawa/StreamManager.h>
 
+#if defined(_MSC_VER) && defined(_WIN64)
+#include <intrin.h>
+#define ALEMBIC_OGAWA_STREAM_CAS 1
+#elif !defined(__APPLE__) && defined(__GNUC__) && \
+    ( __GNUC__ > 4 || ( __GNUC__ == 4 && __GNUC_MINOR__ >= 4 ) )
+#define ALEMBIC_OGAWA_STREAM_CAS 1
+#endif
+
 namespace Alembic {
 namespace AbcCoreOgawa {
 namespace ALEMBIC_VERSION_NS {
 
+#ifdef ALEMBIC_OGAWA_STREAM_CAS
+
+//-*****************************************************************************
+// index (1 based) of the lowest set bit, 0 if no bit is set
+static inline Alembic::Util::int64_t lowestBit( Alembic::Util::int64_t iVal )
+{
+#ifdef _MSC_VER
+    unsigned long index = 0;
+    if ( _BitScanForward64( &index, ( unsigned __int64 ) iVal ) )
+    {
+        return ( Alembic::Util::int64_t ) index + 1;
+    }
+    return 0;
+#else
+    return ffsll( iVal );
+#endif
+}
+
+//-*****************************************************************************
+static inline bool compareAndSwap( Alembic::Util::int64_t * iPtr,
+                                   Alembic::Util::int64_t iOldVal,
+                                   Alembic::Util::int64_t iNewVal )
+{
+#ifdef _MSC_VER
+    return _InterlockedCompareExchange64( ( volatile __int64 * ) iPtr,
+        iNewVal, iOldVal ) == iOldVal;
+#else
+    return __sync_bool_compare_and_swap( iPtr, iOldVal, iNewVal );
+#endif
+}
+
+#endif
+
 StreamManager::StreamManager( std::size_t iNumStreams )
 {
 
@@ -55,9 +96,9 @@ StreamManager::StreamManager( std::size_t iNumStreams )
         for ( std::size_t i = 0; i < m_numStreams; ++i )
         {
             m_streamIDs[i] = i;
-            if ( m_numStreams < sizeof(m_streams) * 8 )
+            if ( m_numStreams <= sizeof(m_streams) * 8 )
             {
-                m_streams |= 1 << i;
+                m_streams |= Alembic::Util::int64_t( 1 ) << i;
             }
         }
     }
@@ -69,7 +110,7 @@ StreamManager::~StreamManager()
 {
 }
 
-#if !defined(__APPLE__) && defined(__GNUC__) && __GNUC__ >= 4 && __GNUC_MINOR__ >= 4
+#ifdef ALEMBIC_OGAWA_STREAM_CAS
 
 StreamIDPtr StreamManager::get()
 {
@@ -102,16 +143,16 @@ StreamIDPtr StreamManager::get()
     do
     {
         oldVal = m_streams;
-        val = ffsll( oldVal );
+        val = lowestBit( oldVal );
 
         if ( val == 0 )
         {
             return m_default;
         }
 
-        newVal = oldVal & ~( 1 << (val - 1) );
+        newVal = oldVal & ~( Alembic::Util::int64_t( 1 ) << ( val - 1 ) );
     }
-    while ( !__sync_bool_compare_and_swap( &m_streams, oldVal, newVal ) );
+    while ( !compareAndSwap( &m_streams, oldVal, newVal ) );
 
     return StreamIDPtr( new StreamID( this, ( std::size_t ) val - 1 ) );
 }
@@ -137,10 +178,10 @@ void StreamManager::put( std::size_t iStreamID )
     do
     {
         oldVal = m_streams;
-        newVal = oldVal | ( 1 << iStreamID );
+        newVal = oldVal | ( Alembic::Util::int64_t( 1 ) << iStreamID );
 
     }
-    while ( !__sync_bool_compare_and_swap( &m_streams, oldVal, newVal ) );
+    while ( !compareAndSwap( &m_streams, oldVal, newVal ) );
 }
 
 #else
@@ -49,7 +49,8 @@ namespace ALEMBIC_VERSION_NS {
 class IArchive
 {
 public:
-    IArchive(const std::string & iFileName, std::size_t iNumStreams=1);
+    IArchive(const std::string & iFileName, std::size_t iNumStreams=1,
+             bool iUseMMap=false);
     IArchive(const std::vector< std::istream * > & iStreams);
     ~IArchive();
 
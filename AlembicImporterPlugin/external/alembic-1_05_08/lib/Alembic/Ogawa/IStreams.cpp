@@ -36,6 +36,23 @@
 #include <Alembic/Ogawa/IStreams.h>
 #include <fstream>
 #include <stdexcept>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace Alembic {
 namespace Ogawa {
@@ -50,6 +67,12 @@ public:
         valid = false;
         frozen = false;
         version = 0;
+        mapped = NULL;
+        mappedSize = 0;
+#ifdef _WIN32
+        fileHandle = INVALID_HANDLE_VALUE;
+        mappingHandle = NULL;
+#endif
     }
 
     ~PrivateData()
@@ -59,6 +82,8 @@ public:
             delete [] locks;
         }
 
+        unmap();
+
         // only cleanup if we were the ones who opened it
         if (!fileName.empty())
         {
@@ -75,6 +100,33 @@ public:
         }
     }
 
+    void unmap()
+    {
+#ifdef _WIN32
+        if (mapped)
+        {
+            UnmapViewOfFile(mapped);
+        }
+        if (mappingHandle != NULL)
+        {
+            CloseHandle(mappingHandle);
+        }
+        if (fileHandle != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(fileHandle);
+        }
+        fileHandle = INVALID_HANDLE_VALUE;
+        mappingHandle = NULL;
+#else
+        if (mapped)
+        {
+            munmap((void *)mapped, mappedSize);
+        }
+#endif
+        mapped = NULL;
+        mappedSize = 0;
+    }
+
     std::vector<std::istream *> streams;
     std::vector<Alembic::Util::uint64_t> offsets;
     Alembic::Util::mutex * locks;
@@ -82,11 +134,24 @@ public:
     bool valid;
     bool frozen;
     Alembic::Util::uint16_t version;
+
+    // read-only view of the whole file when memory mapped
+    const char * mapped;
+    Alembic::Util::uint64_t mappedSize;
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#endif
 };
 
-IStreams::IStreams(const std::string & iFileName, std::size_t iNumStreams) :
+IStreams::IStreams(const std::string & iFileName, std::size_t iNumStreams,
+                   bool iUseMMap) :
     mData(new IStreams::PrivateData())
 {
+    if (iUseMMap && initMapped(iFileName))
+    {
+        return;
+    }
 
     std::ifstream * filestream = new std::ifstream;
     filestream->open(iFileName.c_str(), std::ios::binary);
@@ -132,6 +197,85 @@ IStreams::IStreams(const std::vector< std::istream * > & iStreams) :
     mData->locks = new Alembic::Util::mutex[mData->streams.size()];
 }
 
+bool IStreams::initMapped(const std::string & iFileName)
+{
+#ifdef _WIN32
+    mData->fileHandle = CreateFileA(iFileName.c_str(), GENERIC_READ,
+        FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (mData->fileHandle == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mData->fileHandle, &size) || size.QuadPart < 16)
+    {
+        mData->unmap();
+        return false;
+    }
+
+    mData->mappingHandle = CreateFileMappingA(mData->fileHandle, NULL,
+        PAGE_READONLY, 0, 0, NULL);
+    if (mData->mappingHandle == NULL)
+    {
+        mData->unmap();
+        return false;
+    }
+
+    mData->mapped = (const char *)MapViewOfFile(mData->mappingHandle,
+        FILE_MAP_READ, 0, 0, 0);
+    if (mData->mapped == NULL)
+    {
+        mData->unmap();
+        return false;
+    }
+    mData->mappedSize = size.QuadPart;
+#else
+    int fd = open(iFileName.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 16)
+    {
+        close(fd);
+        return false;
+    }
+
+    void * ptr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+    // the mapping keeps its own reference to the file
+    close(fd);
+
+    if (ptr == MAP_FAILED)
+    {
+        return false;
+    }
+    mData->mapped = (const char *)ptr;
+    mData->mappedSize = st.st_size;
+#endif
+
+    const char * header = mData->mapped;
+    std::string magicStr(header, 5);
+    mData->frozen = (header[5] == char(0xff));
+    mData->version = (header[6] << 8) | header[7];
+    mData->valid = (magicStr == "Ogawa");
+
+    if (!mData->valid || mData->version != 1)
+    {
+        mData->valid = false;
+        mData->frozen = false;
+        mData->version = 0;
+        mData->unmap();
+        return false;
+    }
+
+    mData->fileName = iFileName;
+    return true;
+}
+
 void IStreams::init()
 {
     // simple temporary endian check
@@ -211,6 +355,11 @@ Alembic::Util::uint16_t IStreams::getVersion()
     return mData->version;
 }
 
+bool IStreams::isMapped()
+{
+    return mData->mapped != NULL;
+}
+
 void IStreams::read(std::size_t iThreadId, Alembic::Util::uint64_t iPos,
                     Alembic::Util::uint64_t iSize, void * oBuf)
 {
@@ -219,6 +368,18 @@ void IStreams::read(std::size_t iThreadId, Alembic::Util::uint64_t iPos,
         return;
     }
 
+    // no stream state to protect, so no lock
+    if (mData->mapped)
+    {
+        if (iPos < mData->mappedSize)
+        {
+            Alembic::Util::uint64_t size =
+                std::min(iSize, mData->mappedSize - iPos);
+            std::memcpy(oBuf, mData->mapped + iPos, size);
+        }
+        return;
+    }
+
     std::size_t threadId = 0;
     if (iThreadId < mData->streams.size())
     {
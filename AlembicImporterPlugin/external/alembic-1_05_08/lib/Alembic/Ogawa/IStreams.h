@@ -47,7 +47,11 @@ namespace ALEMBIC_VERSION_NS {
 class IStreams
 {
 public:
-    IStreams(const std::string & iFileName, std::size_t iNumStreams=1);
+    // if iUseMMap is true the file is mapped read-only and read() becomes a
+    // lock free memcpy from the mapping, if the mapping can't be created
+    // iNumStreams file streams are used instead
+    IStreams(const std::string & iFileName, std::size_t iNumStreams=1,
+             bool iUseMMap=false);
     IStreams(const std::vector< std::istream * > & iStreams);
     ~IStreams();
 
@@ -55,7 +59,10 @@ public:
     bool isFrozen();
     Alembic::Util::uint16_t getVersion();
 
+    bool isMapped();
+
     // locks on the threadId, seeks to iPos, and reads iSize bytes into oBuf
+    // (copies straight from the mapping when isMapped())
     void read(std::size_t iThreadId, Alembic::Util::uint64_t iPos,
               Alembic::Util::uint64_t iSize, void * oBuf);
 
@@ -65,6 +72,7 @@ private:
     const IStreams & operator=(const IStreams &);
 
     void init();
+    bool initMapped(const std::string & iFileName);
 
     class PrivateData;
     Alembic::Util::auto_ptr< PrivateData > mData;
@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <map>
+#include <unordered_map>
 #include <memory>
 #include <thread>
 #include <mutex>
@@ -45,10 +46,13 @@ void aiDebugLogImpl(const char* fmt, ...);
 #pragma comment(lib, "AlembicAbcCoreAbstract.lib")
 #pragma comment(lib, "AlembicAbcCoreFactory.lib")
 #pragma comment(lib, "AlembicAbcCoreHDF5.lib")
+#ifndef aiWithPatchedOgawa
+// otherwise the patched sources in external/alembic-1_05_08 are built along with the plugin
 #pragma comment(lib, "AlembicAbcCoreOgawa.lib")
+#pragma comment(lib, "AlembicOgawa.lib")
+#endif // aiWithPatchedOgawa
 #pragma comment(lib, "AlembicAbcGeom.lib")
 #pragma comment(lib, "AlembicAbcMaterial.lib")
-#pragma comment(lib, "AlembicOgawa.lib")
 #pragma comment(lib, "AlembicUtil.lib")
 #pragma comment(lib, "libhdf5.lib")
 #pragma comment(lib, "libhdf5_hl.lib")
@@ -67,6 +71,7 @@ using namespace Alembic;
 
 typedef Abc::V2f       abcV2;
 typedef Abc::V3f       abcV3;
+typedef Imath::V4f     abcV4;
 typedef Abc::M44f      abcM44;
 typedef Abc::IObject   abcObject;
 struct  aiCameraParams;